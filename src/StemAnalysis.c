@@ -0,0 +1,721 @@
+//
+//  StemAnalysis.c
+//  Tempo, beat grid and key analysis over separated stems (portable C)
+//
+
+#include "StemAnalysis.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+// Analysis configuration
+#define FFT_SIZE 2048
+#define FFT_HALF (FFT_SIZE / 2)
+#define HOP_SIZE 512
+#define MIN_BPM 40.0
+#define MAX_BPM 240.0
+#define PRIOR_BPM 120.0
+#define BEAT_TIGHTNESS 100.0
+#define CHROMA_MIN_HZ 55.0
+#define CHROMA_MAX_HZ 5000.0
+#define MIN_ANALYSIS_SECONDS 4.0
+
+#define SIDECAR_MAGIC "STAN"
+#define SIDECAR_VERSION 2
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#pragma mark - Real FFT
+
+// Precomputed tables for a FFT_SIZE-point real FFT done as a half-size complex FFT
+typedef struct {
+    float window[FFT_SIZE];
+    float twiddleRe[FFT_HALF / 2];
+    float twiddleIm[FFT_HALF / 2];
+    float postRe[FFT_HALF + 1];
+    float postIm[FFT_HALF + 1];
+    uint16_t bitReverse[FFT_HALF];
+    double binHz;
+} FFTPlan;
+
+static void FFTPlanInit(FFTPlan *plan, double sampleRate) {
+    for (int n = 0; n < FFT_SIZE; n++) {
+        plan->window[n] = (float)(0.5 - 0.5 * cos(2.0 * M_PI * n / FFT_SIZE));
+    }
+    for (int k = 0; k < FFT_HALF / 2; k++) {
+        plan->twiddleRe[k] = (float)cos(2.0 * M_PI * k / FFT_HALF);
+        plan->twiddleIm[k] = (float)-sin(2.0 * M_PI * k / FFT_HALF);
+    }
+    for (int k = 0; k <= FFT_HALF; k++) {
+        plan->postRe[k] = (float)cos(2.0 * M_PI * k / FFT_SIZE);
+        plan->postIm[k] = (float)-sin(2.0 * M_PI * k / FFT_SIZE);
+    }
+
+    int bits = 0;
+    while ((1 << bits) < FFT_HALF) bits++;
+    for (int i = 0; i < FFT_HALF; i++) {
+        int reversed = 0;
+        for (int b = 0; b < bits; b++) {
+            if (i & (1 << b)) reversed |= 1 << (bits - 1 - b);
+        }
+        plan->bitReverse[i] = (uint16_t)reversed;
+    }
+
+    plan->binHz = sampleRate / FFT_SIZE;
+}
+
+// Windowed magnitude spectrum of FFT_SIZE samples into magnitude[FFT_HALF + 1]
+static void FFTMagnitude(const FFTPlan *plan, const float *input, float *magnitude) {
+    float re[FFT_HALF];
+    float im[FFT_HALF];
+
+    // Pack even/odd samples as real/imaginary parts, bit-reversed
+    for (int n = 0; n < FFT_HALF; n++) {
+        int r = plan->bitReverse[n];
+        re[r] = input[2 * n] * plan->window[2 * n];
+        im[r] = input[2 * n + 1] * plan->window[2 * n + 1];
+    }
+
+    for (int size = 2; size <= FFT_HALF; size <<= 1) {
+        int half = size >> 1;
+        int step = FFT_HALF / size;
+        for (int start = 0; start < FFT_HALF; start += size) {
+            for (int j = 0; j < half; j++) {
+                float wr = plan->twiddleRe[j * step];
+                float wi = plan->twiddleIm[j * step];
+                int a = start + j;
+                int b = a + half;
+                float tr = wr * re[b] - wi * im[b];
+                float ti = wr * im[b] + wi * re[b];
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+
+    // Split the half-size result into the real-input spectrum
+    for (int k = 0; k <= FFT_HALF; k++) {
+        int k1 = k % FFT_HALF;
+        int k2 = (FFT_HALF - k) % FFT_HALF;
+        float evenRe = 0.5f * (re[k1] + re[k2]);
+        float evenIm = 0.5f * (im[k1] - im[k2]);
+        float oddRe = 0.5f * (im[k1] + im[k2]);
+        float oddIm = -0.5f * (re[k1] - re[k2]);
+        float xr = evenRe + plan->postRe[k] * oddRe - plan->postIm[k] * oddIm;
+        float xi = evenIm + plan->postRe[k] * oddIm + plan->postIm[k] * oddRe;
+        magnitude[k] = sqrtf(xr * xr + xi * xi);
+    }
+}
+
+#pragma mark - Vector Log
+
+// Natural log of a positive, normal float to about 1 ulp (Cephes logf). Unlike
+// logf it is branch-free and inline, so loops over spectrum bins vectorise.
+static inline float FastLog(float x) {
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    uint32_t mantissa = bits & 0x007fffffu;
+
+    // Mantissa into [sqrt(1/2), sqrt(2)) so the polynomial stays accurate. The
+    // test is on the bits: a float compare would keep the loop from vectorising.
+    int32_t high = mantissa > 0x3504f3u;
+    int32_t exponent = (int32_t)(bits >> 23) - 127 + high;
+    bits = mantissa | (high ? 0x3f000000u : 0x3f800000u);
+    float m;
+    memcpy(&m, &bits, sizeof(m));
+    float e = (float)exponent;
+
+    float f = m - 1.0f;
+    float z = f * f;
+    float y = 7.0376836292e-2f;
+    y = y * f - 1.1514610310e-1f;
+    y = y * f + 1.1676998740e-1f;
+    y = y * f - 1.2420140846e-1f;
+    y = y * f + 1.4249322787e-1f;
+    y = y * f - 1.6668057665e-1f;
+    y = y * f + 2.0000714765e-1f;
+    y = y * f - 2.4999993993e-1f;
+    y = y * f + 3.3333331174e-1f;
+    y = y * f * z - 2.12194440e-4f * e - 0.5f * z;
+    return f + y + 0.693359375f * e;
+}
+
+#pragma mark - Per-stem Features
+
+static float OnsetWeightForRole(StemRole role) {
+    switch (role) {
+        case StemRoleDrums:  return 1.0f;
+        case StemRoleBass:   return 0.5f;
+        case StemRoleOther:  return 0.3f;
+        case StemRoleVocals: return 0.1f;
+    }
+    return 0.0f;
+}
+
+static float ChromaWeightForRole(StemRole role) {
+    switch (role) {
+        case StemRoleDrums:  return 0.0f;
+        case StemRoleBass:   return 1.0f;
+        case StemRoleOther:  return 1.0f;
+        case StemRoleVocals: return 0.5f;
+    }
+    return 0.0f;
+}
+
+// Spectral-flux onset envelope and frame-normalised chroma for one stem.
+// The per-bin passes (log magnitudes, rectified flux) are written so -O3
+// vectorises them; only the few spectral peaks per frame are handled singly.
+static void AnalyseStemFrames(const FFTPlan *plan, const float *samples, size_t frameCount,
+                              float *onset, double *chroma) {
+    float magnitude[FFT_HALF + 1];
+    float logMagnitude[FFT_HALF + 1];
+    float logPrev[FFT_HALF + 1];
+    float logCur[FFT_HALF + 1];
+
+    int firstBin = (int)(CHROMA_MIN_HZ / plan->binHz) + 1;
+    int lastBin = (int)(CHROMA_MAX_HZ / plan->binHz);
+    if (lastBin > FFT_HALF - 1) lastBin = FFT_HALF - 1;
+    const float semitonesPerLog = (float)(12.0 / log(2.0));
+    const float midiOffset = (float)(69.0 - 12.0 * log2(440.0 / plan->binHz));
+
+    for (size_t t = 0; t < frameCount; t++) {
+        FFTMagnitude(plan, samples + t * HOP_SIZE, magnitude);
+
+        if (onset) {
+            for (int k = 0; k <= FFT_HALF; k++) {
+                logCur[k] = FastLog(1.0f + 1000.0f * magnitude[k]);
+            }
+            // Independent partial sums so the reduction vectorises without
+            // reassociating floats behind the compiler's back
+            float partial[8] = {0};
+            if (t > 0) {
+                for (int k = 1; k <= FFT_HALF; k += 8) {
+                    for (int j = 0; j < 8; j++) {
+                        float diff = logCur[k + j] - logPrev[k + j];
+                        partial[j] += diff > 0.0f ? diff : 0.0f;
+                    }
+                }
+            }
+            onset[t] = ((partial[0] + partial[1]) + (partial[2] + partial[3])) +
+                       ((partial[4] + partial[5]) + (partial[6] + partial[7]));
+            memcpy(logPrev, logCur, sizeof(logCur));
+        }
+
+        if (chroma) {
+            // Bins are wider than a semitone in the bass range, so only spectral
+            // peaks count, at their interpolated frequency, to avoid window leakage
+            for (int k = firstBin - 1; k <= lastBin + 1; k++) {
+                logMagnitude[k] = FastLog(magnitude[k] + 1e-9f);
+            }
+            float frameChroma[12] = {0};
+            for (int k = firstBin; k <= lastBin; k++) {
+                float a = magnitude[k - 1], b = magnitude[k], c = magnitude[k + 1];
+                if (b <= a || b < c || b < 1e-4f) continue;
+                float la = logMagnitude[k - 1], lb = logMagnitude[k], lc = logMagnitude[k + 1];
+                float curvature = la - 2.0f * lb + lc;
+                float offset = curvature < 0.0f ? 0.5f * (la - lc) / curvature : 0.0f;
+                // MIDI note of bin k + offset: 12 * log2((k + offset) * binHz / 440) + 69
+                long midi = lroundf(semitonesPerLog * FastLog(k + offset) + midiOffset);
+                frameChroma[((midi % 12) + 12) % 12] += b;
+            }
+            float peak = 0.0f;
+            for (int i = 0; i < 12; i++) {
+                if (frameChroma[i] > peak) peak = frameChroma[i];
+            }
+            if (peak > 1e-4f) {
+                for (int i = 0; i < 12; i++) {
+                    chroma[i] += frameChroma[i] / peak;
+                }
+            }
+        }
+    }
+}
+
+// Removes the local mean, half-wave rectifies and scales to unit deviation
+static void NormaliseOnset(float *onset, size_t count, size_t window) {
+    double *prefix = malloc((count + 1) * sizeof(double));
+    float *detrended = malloc(count * sizeof(float));
+    if (!prefix || !detrended) {
+        free(prefix);
+        free(detrended);
+        return;
+    }
+
+    prefix[0] = 0.0;
+    for (size_t t = 0; t < count; t++) prefix[t + 1] = prefix[t] + onset[t];
+
+    double sumSquares = 0.0;
+    for (size_t t = 0; t < count; t++) {
+        size_t lo = t > window ? t - window : 0;
+        size_t hi = t + window + 1 < count ? t + window + 1 : count;
+        double mean = (prefix[hi] - prefix[lo]) / (double)(hi - lo);
+        float value = onset[t] - (float)mean;
+        detrended[t] = value > 0.0f ? value : 0.0f;
+        sumSquares += (double)detrended[t] * detrended[t];
+    }
+
+    float scale = sumSquares > 0.0 ? (float)(1.0 / sqrt(sumSquares / count)) : 0.0f;
+    for (size_t t = 0; t < count; t++) onset[t] = detrended[t] * scale;
+
+    free(prefix);
+    free(detrended);
+}
+
+#pragma mark - Tempo and Beats
+
+// Autocorrelation tempo with a log-normal prior around PRIOR_BPM. Returns period in frames.
+static double EstimatePeriod(const float *onset, size_t count, double frameRate, float *confidence) {
+    size_t minLag = (size_t)floor(60.0 * frameRate / MAX_BPM);
+    size_t maxLag = (size_t)ceil(60.0 * frameRate / MIN_BPM);
+    if (minLag < 1) minLag = 1;
+    if (maxLag > count / 2) maxLag = count / 2;
+
+    double zeroLag = 0.0;
+    for (size_t t = 0; t < count; t++) zeroLag += (double)onset[t] * onset[t];
+    *confidence = 0.0f;
+    if (zeroLag <= 0.0 || maxLag <= minLag + 1) return 60.0 * frameRate / PRIOR_BPM;
+
+    double *ac = calloc(maxLag + 2, sizeof(double));
+    if (!ac) return 60.0 * frameRate / PRIOR_BPM;
+
+    size_t bestLag = minLag;
+    double bestScore = -1.0;
+    for (size_t lag = minLag - 1; lag <= maxLag + 1 && lag < count; lag++) {
+        double sum = 0.0;
+        for (size_t t = 0; t + lag < count; t++) sum += onset[t] * onset[t + lag];
+        ac[lag] = sum / (double)(count - lag);
+
+        if (lag < minLag || lag > maxLag) continue;
+        double bpm = 60.0 * frameRate / lag;
+        double octaves = log2(bpm / PRIOR_BPM);
+        double score = ac[lag] * exp(-0.5 * octaves * octaves);
+        if (score > bestScore) {
+            bestScore = score;
+            bestLag = lag;
+        }
+    }
+
+    // Parabolic refinement of the peak
+    double period = (double)bestLag;
+    double left = ac[bestLag - 1], centre = ac[bestLag], right = ac[bestLag + 1];
+    double denominator = left - 2.0 * centre + right;
+    if (denominator < 0.0) {
+        double offset = 0.5 * (left - right) / denominator;
+        if (offset > -1.0 && offset < 1.0) period += offset;
+    }
+
+    double normalised = centre / (zeroLag / count);
+    *confidence = (float)(normalised < 0.0 ? 0.0 : normalised > 1.0 ? 1.0 : normalised);
+    free(ac);
+    return period;
+}
+
+// Dynamic-programming beat tracker (Ellis 2007). Returns beat frame indices.
+static size_t TrackBeats(const float *onset, size_t count, double period, uint32_t **outBeats) {
+    *outBeats = NULL;
+    size_t minGap = (size_t)lround(period / 2.0);
+    size_t maxGap = (size_t)lround(period * 2.0);
+    if (minGap < 1) minGap = 1;
+    if (count == 0 || maxGap <= minGap) return 0;
+
+    float *score = malloc(count * sizeof(float));
+    int32_t *backlink = malloc(count * sizeof(int32_t));
+    float *penalty = malloc((maxGap + 1) * sizeof(float));
+    if (!score || !backlink || !penalty) {
+        free(score);
+        free(backlink);
+        free(penalty);
+        return 0;
+    }
+
+    for (size_t gap = minGap; gap <= maxGap; gap++) {
+        double ratio = log((double)gap / period);
+        penalty[gap] = (float)(-BEAT_TIGHTNESS * ratio * ratio);
+    }
+
+    for (size_t t = 0; t < count; t++) {
+        float best = 0.0f;
+        int32_t link = -1;
+        if (t >= minGap) {
+            size_t firstGap = minGap;
+            size_t lastGap = maxGap < t ? maxGap : t;
+            best = -INFINITY;
+            for (size_t gap = firstGap; gap <= lastGap; gap++) {
+                float candidate = score[t - gap] + penalty[gap];
+                if (candidate > best) {
+                    best = candidate;
+                    link = (int32_t)(t - gap);
+                }
+            }
+        }
+        score[t] = onset[t] + best;
+        backlink[t] = link;
+    }
+
+    // Best ending within the final period
+    size_t tail = (size_t)ceil(period);
+    size_t end = count - 1;
+    for (size_t t = count > tail ? count - tail : 0; t < count; t++) {
+        if (score[t] > score[end]) end = t;
+    }
+
+    size_t beatCount = 0;
+    for (int32_t t = (int32_t)end; t >= 0; t = backlink[t]) beatCount++;
+
+    uint32_t *beats = malloc(beatCount * sizeof(uint32_t));
+    if (beats) {
+        size_t i = beatCount;
+        for (int32_t t = (int32_t)end; t >= 0; t = backlink[t]) beats[--i] = (uint32_t)t;
+
+        // Trim leading/trailing beats that sit in silence
+        double energy = 0.0;
+        for (size_t b = 0; b < beatCount; b++) energy += (double)onset[beats[b]] * onset[beats[b]];
+        float threshold = beatCount ? (float)(0.5 * sqrt(energy / beatCount)) : 0.0f;
+        size_t first = 0, last = beatCount;
+        while (first < last && onset[beats[first]] < threshold) first++;
+        while (last > first && onset[beats[last - 1]] < threshold) last--;
+        memmove(beats, beats + first, (last - first) * sizeof(uint32_t));
+        beatCount = last - first;
+    } else {
+        beatCount = 0;
+    }
+
+    free(score);
+    free(backlink);
+    free(penalty);
+    *outBeats = beats;
+    return beatCount;
+}
+
+#pragma mark - Key
+
+// Krumhansl-Kessler key profiles, index 0 = tonic
+static const double kMajorProfile[12] = {6.35, 2.23, 3.48, 2.33, 4.38, 4.09, 2.52, 5.19, 2.39, 3.66, 2.29, 2.88};
+static const double kMinorProfile[12] = {6.33, 2.68, 3.52, 5.38, 2.60, 3.53, 2.54, 4.75, 3.98, 2.69, 3.34, 3.17};
+
+static double Correlate(const double *chroma, const double *profile, int tonic) {
+    double meanC = 0.0, meanP = 0.0;
+    for (int i = 0; i < 12; i++) {
+        meanC += chroma[i];
+        meanP += profile[i];
+    }
+    meanC /= 12.0;
+    meanP /= 12.0;
+
+    double cross = 0.0, varC = 0.0, varP = 0.0;
+    for (int i = 0; i < 12; i++) {
+        double c = chroma[(i + tonic) % 12] - meanC;
+        double p = profile[i] - meanP;
+        cross += c * p;
+        varC += c * c;
+        varP += p * p;
+    }
+    return (varC > 0.0 && varP > 0.0) ? cross / sqrt(varC * varP) : 0.0;
+}
+
+static void EstimateKey(const double *chroma, StemAnalysisResult *result) {
+    double best = -2.0;
+    result->keyTonic = 0;
+    result->keyMode = StemKeyModeMajor;
+    for (int tonic = 0; tonic < 12; tonic++) {
+        double major = Correlate(chroma, kMajorProfile, tonic);
+        double minor = Correlate(chroma, kMinorProfile, tonic);
+        if (major > best) {
+            best = major;
+            result->keyTonic = tonic;
+            result->keyMode = StemKeyModeMajor;
+        }
+        if (minor > best) {
+            best = minor;
+            result->keyTonic = tonic;
+            result->keyMode = StemKeyModeMinor;
+        }
+    }
+    result->keyConfidence = best > 0.0 ? (float)best : 0.0f;
+}
+
+#pragma mark - Public API
+
+StemRole StemRoleForName(const char *fileName) {
+    char lowered[64];
+    size_t i = 0;
+    for (; fileName[i] && i < sizeof(lowered) - 1; i++) {
+        lowered[i] = (char)tolower((unsigned char)fileName[i]);
+    }
+    lowered[i] = '\0';
+
+    if (strstr(lowered, "drum")) return StemRoleDrums;
+    if (strstr(lowered, "bass")) return StemRoleBass;
+    if (strstr(lowered, "vocal")) return StemRoleVocals;
+    return StemRoleOther;
+}
+
+int StemAnalysisRun(const StemAnalysisInput *stems, size_t stemCount, double sampleRate, StemAnalysisResult *result) {
+    memset(result, 0, sizeof(*result));
+    if (stemCount == 0 || sampleRate <= 0.0) return -1;
+
+    // Stems of one song share a timeline; analyse the common length
+    size_t sampleCount = stems[0].frameCount;
+    for (size_t s = 1; s < stemCount; s++) {
+        if (stems[s].frameCount < sampleCount) sampleCount = stems[s].frameCount;
+    }
+    if (sampleCount < (size_t)(MIN_ANALYSIS_SECONDS * sampleRate) || sampleCount < FFT_SIZE) return -1;
+
+    size_t frameCount = 1 + (sampleCount - FFT_SIZE) / HOP_SIZE;
+    double frameRate = sampleRate / HOP_SIZE;
+
+    FFTPlan *plan = malloc(sizeof(FFTPlan));
+    float *combined = calloc(frameCount, sizeof(float));
+    float *stemOnset = malloc(frameCount * sizeof(float));
+    if (!plan || !combined || !stemOnset) {
+        free(plan);
+        free(combined);
+        free(stemOnset);
+        return -1;
+    }
+    FFTPlanInit(plan, sampleRate);
+
+    double chroma[12] = {0};
+    size_t detrendWindow = (size_t)lround(0.2 * frameRate);
+
+    for (size_t s = 0; s < stemCount; s++) {
+        float onsetWeight = OnsetWeightForRole(stems[s].role);
+        float chromaWeight = ChromaWeightForRole(stems[s].role);
+        double stemChroma[12] = {0};
+
+        AnalyseStemFrames(plan, stems[s].samples, frameCount,
+                          onsetWeight > 0.0f ? stemOnset : NULL,
+                          chromaWeight > 0.0f ? stemChroma : NULL);
+
+        if (onsetWeight > 0.0f) {
+            NormaliseOnset(stemOnset, frameCount, detrendWindow);
+            for (size_t t = 0; t < frameCount; t++) combined[t] += onsetWeight * stemOnset[t];
+        }
+        for (int i = 0; i < 12; i++) chroma[i] += chromaWeight * stemChroma[i];
+    }
+
+    NormaliseOnset(combined, frameCount, detrendWindow);
+
+    double period = EstimatePeriod(combined, frameCount, frameRate, &result->tempoConfidence);
+    uint32_t *beatFrames = NULL;
+    size_t beatCount = TrackBeats(combined, frameCount, period, &beatFrames);
+
+    result->sampleRate = sampleRate;
+    result->duration = sampleCount / sampleRate;
+    result->bpm = (float)(60.0 * frameRate / period);
+    result->beatCount = (uint32_t)beatCount;
+    result->beatTimes = malloc((beatCount ? beatCount : 1) * sizeof(float));
+    if (result->beatTimes) {
+        for (size_t b = 0; b < beatCount; b++) {
+            result->beatTimes[b] = (float)((beatFrames[b] * (double)HOP_SIZE + FFT_SIZE / 2) / sampleRate);
+        }
+    } else {
+        result->beatCount = 0;
+    }
+
+    EstimateKey(chroma, result);
+
+    free(beatFrames);
+    free(plan);
+    free(combined);
+    free(stemOnset);
+    return 0;
+}
+
+void StemAnalysisResultFree(StemAnalysisResult *result) {
+    free(result->beatTimes);
+    result->beatTimes = NULL;
+    result->beatCount = 0;
+}
+
+#pragma mark - Sidecar
+
+static void PutLE32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t GetLE32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void PutFloat(uint8_t *p, float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    PutLE32(p, bits);
+}
+
+static float GetFloat(const uint8_t *p) {
+    uint32_t bits = GetLE32(p);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+static int CompareStemFiles(const void *a, const void *b) {
+    const StemAnalysisStemFile *x = a, *y = b;
+    if (x->bytes != y->bytes) return x->bytes < y->bytes ? -1 : 1;
+    return (x->modified > y->modified) - (x->modified < y->modified);
+}
+
+int StemAnalysisSourcesForPaths(const char *const *paths, size_t count, StemAnalysisSources *sources) {
+    memset(sources, 0, sizeof(*sources));
+    if (count > STEM_ANALYSIS_MAX_STEMS) return -1;
+
+    for (size_t i = 0; i < count; i++) {
+        struct stat info;
+        if (stat(paths[i], &info) != 0) return -1;
+        sources->stems[i].bytes = (uint64_t)info.st_size;
+        sources->stems[i].modified = (int64_t)info.st_mtime;
+    }
+    // Sorted so directory listing order doesn't matter
+    qsort(sources->stems, count, sizeof(StemAnalysisStemFile), CompareStemFiles);
+    sources->stemCount = (uint32_t)count;
+    return 0;
+}
+
+static void PutLE64(uint8_t *p, uint64_t v) {
+    PutLE32(p, (uint32_t)v);
+    PutLE32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint64_t GetLE64(const uint8_t *p) {
+    return GetLE32(p) | ((uint64_t)GetLE32(p + 4) << 32);
+}
+
+// magic, version, sampleRate, duration(ms), bpm, tempoConf, tonic, mode, keyConf,
+// stemCount, beatCount, then per stem its size and mtime (64-bit each), then
+// beatCount beat times
+#define SIDECAR_HEADER_SIZE 44
+#define SIDECAR_STEM_SIZE 16
+
+int StemAnalysisWriteSidecar(const char *path, const StemAnalysisResult *result, const StemAnalysisSources *sources) {
+    if (sources->stemCount == 0 || sources->stemCount > STEM_ANALYSIS_MAX_STEMS) return -1;
+
+    size_t sourcesSize = (size_t)sources->stemCount * SIDECAR_STEM_SIZE;
+    size_t size = SIDECAR_HEADER_SIZE + sourcesSize + (size_t)result->beatCount * 4;
+    uint8_t *buffer = malloc(size);
+    if (!buffer) return -1;
+
+    memcpy(buffer, SIDECAR_MAGIC, 4);
+    PutLE32(buffer + 4, SIDECAR_VERSION);
+    PutLE32(buffer + 8, (uint32_t)lround(result->sampleRate));
+    PutLE32(buffer + 12, (uint32_t)llround(result->duration * 1000.0));
+    PutFloat(buffer + 16, result->bpm);
+    PutFloat(buffer + 20, result->tempoConfidence);
+    PutLE32(buffer + 24, (uint32_t)result->keyTonic);
+    PutLE32(buffer + 28, (uint32_t)result->keyMode);
+    PutFloat(buffer + 32, result->keyConfidence);
+    PutLE32(buffer + 36, sources->stemCount);
+    PutLE32(buffer + 40, result->beatCount);
+    for (uint32_t i = 0; i < sources->stemCount; i++) {
+        PutLE64(buffer + SIDECAR_HEADER_SIZE + i * SIDECAR_STEM_SIZE, sources->stems[i].bytes);
+        PutLE64(buffer + SIDECAR_HEADER_SIZE + i * SIDECAR_STEM_SIZE + 8, (uint64_t)sources->stems[i].modified);
+    }
+    for (uint32_t b = 0; b < result->beatCount; b++) {
+        PutFloat(buffer + SIDECAR_HEADER_SIZE + sourcesSize + b * 4, result->beatTimes[b]);
+    }
+
+    // Write-then-rename so concurrent readers never see a partial sidecar
+    char tempPath[4096];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+    FILE *file = fopen(tempPath, "wb");
+    int ok = file && fwrite(buffer, 1, size, file) == size;
+    if (file) ok = (fclose(file) == 0) && ok;
+    free(buffer);
+
+    if (!ok || rename(tempPath, path) != 0) {
+        remove(tempPath);
+        return -1;
+    }
+    return 0;
+}
+
+int StemAnalysisReadSidecar(const char *path, const StemAnalysisSources *sources, StemAnalysisResult *result) {
+    memset(result, 0, sizeof(*result));
+
+    FILE *file = fopen(path, "rb");
+    struct stat info;
+    if (!file || fstat(fileno(file), &info) != 0) {
+        if (file) fclose(file);
+        return -1;
+    }
+
+    uint8_t header[SIDECAR_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, SIDECAR_MAGIC, 4) != 0 || GetLE32(header + 4) != SIDECAR_VERSION) {
+        fclose(file);
+        return -1;
+    }
+
+    // Nothing from the file is trusted: a truncated or corrupt sidecar is stale.
+    // The beats must be exactly what follows the stem records.
+    uint32_t tonic = GetLE32(header + 24);
+    uint32_t mode = GetLE32(header + 28);
+    uint32_t stemCount = GetLE32(header + 36);
+    uint32_t beatCount = GetLE32(header + 40);
+    uint64_t expectedSize = SIDECAR_HEADER_SIZE + (uint64_t)stemCount * SIDECAR_STEM_SIZE + (uint64_t)beatCount * 4;
+    if (tonic > 11 || mode > StemKeyModeMinor || stemCount > STEM_ANALYSIS_MAX_STEMS ||
+        (uint64_t)info.st_size != expectedSize) {
+        fclose(file);
+        return -1;
+    }
+
+    result->sampleRate = GetLE32(header + 8);
+    result->duration = GetLE32(header + 12) / 1000.0;
+    result->bpm = GetFloat(header + 16);
+    result->tempoConfidence = GetFloat(header + 20);
+    result->keyTonic = (int)tonic;
+    result->keyMode = (StemKeyMode)mode;
+    result->keyConfidence = GetFloat(header + 32);
+
+    // Stale if the stems it was computed from have changed
+    uint8_t stored[STEM_ANALYSIS_MAX_STEMS * SIDECAR_STEM_SIZE];
+    int matches = stemCount == sources->stemCount && stemCount <= STEM_ANALYSIS_MAX_STEMS &&
+                  fread(stored, SIDECAR_STEM_SIZE, stemCount, file) == stemCount;
+    for (uint32_t i = 0; matches && i < stemCount; i++) {
+        const uint8_t *stem = stored + i * SIDECAR_STEM_SIZE;
+        matches = GetLE64(stem) == sources->stems[i].bytes &&
+                  (int64_t)GetLE64(stem + 8) == sources->stems[i].modified;
+    }
+    if (!matches) {
+        fclose(file);
+        return -1;
+    }
+
+    uint8_t *beats = malloc((size_t)beatCount * 4 + 1);
+    result->beatTimes = malloc(((size_t)beatCount + 1) * sizeof(float));
+    if (!beats || !result->beatTimes || fread(beats, 4, beatCount, file) != beatCount) {
+        free(beats);
+        StemAnalysisResultFree(result);
+        fclose(file);
+        return -1;
+    }
+    for (uint32_t b = 0; b < beatCount; b++) result->beatTimes[b] = GetFloat(beats + b * 4);
+    result->beatCount = beatCount;
+
+    free(beats);
+    fclose(file);
+    return 0;
+}
+
+const char *StemAnalysisKeyName(int tonic, StemKeyMode mode) {
+    static const char *const names[2][12] = {
+        {"C major", "C# major", "D major", "Eb major", "E major", "F major",
+         "F# major", "G major", "Ab major", "A major", "Bb major", "B major"},
+        {"C minor", "C# minor", "D minor", "Eb minor", "E minor", "F minor",
+         "F# minor", "G minor", "G# minor", "A minor", "Bb minor", "B minor"}
+    };
+    if (tonic < 0 || tonic > 11) return "Unknown";
+    return names[mode == StemKeyModeMinor ? 1 : 0][tonic];
+}
@@ -0,0 +1,93 @@
+//
+//  StemAnalysis.h
+//  Tempo, beat grid and key analysis over separated stems (portable C)
+//
+//  Onsets come mostly from the drums stem, harmony from bass/other/vocals.
+//  Results are stored in a small binary sidecar next to the cached stems so
+//  each song is analysed once.
+//
+
+#ifndef STEM_ANALYSIS_H
+#define STEM_ANALYSIS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STEM_ANALYSIS_SIDECAR_NAME "analysis.bin"
+#define STEM_ANALYSIS_MAX_STEMS 8
+
+typedef enum {
+    StemRoleDrums = 0,
+    StemRoleBass,
+    StemRoleVocals,
+    StemRoleOther
+} StemRole;
+
+typedef enum {
+    StemKeyModeMajor = 0,
+    StemKeyModeMinor = 1
+} StemKeyMode;
+
+// One mono stem, e.g. decoded drums.mp3 mixed down to a single channel
+typedef struct {
+    const float *samples;
+    size_t frameCount;
+    StemRole role;
+} StemAnalysisInput;
+
+typedef struct {
+    double sampleRate;
+    double duration;          // Seconds
+    float bpm;
+    float tempoConfidence;    // 0..1, autocorrelation peak relative to zero lag
+    int keyTonic;             // Pitch class, 0 = C ... 11 = B
+    StemKeyMode keyMode;
+    float keyConfidence;      // Correlation with the winning key profile
+    uint32_t beatCount;
+    float *beatTimes;         // Seconds, owned by the result
+} StemAnalysisResult;
+
+// The stem files a result was computed from. A sidecar is only valid for the
+// same set of stems: re-downloaded, added or removed stems invalidate it.
+typedef struct {
+    uint64_t bytes;
+    int64_t modified;   // mtime, seconds since the epoch
+} StemAnalysisStemFile;
+
+typedef struct {
+    uint32_t stemCount;
+    StemAnalysisStemFile stems[STEM_ANALYSIS_MAX_STEMS];   // Sorted by size, then mtime
+} StemAnalysisSources;
+
+// Maps a stem file name ("drums.mp3", "Bass.wav") to its role. Unknown names are "other".
+StemRole StemRoleForName(const char *fileName);
+
+// Runs onset detection, tempo estimation, beat tracking and key estimation.
+// Single-threaded and re-entrant: parallelism is across songs.
+// Returns 0 on success, -1 if the input is too short or allocation fails.
+int StemAnalysisRun(const StemAnalysisInput *stems, size_t stemCount, double sampleRate, StemAnalysisResult *result);
+void StemAnalysisResultFree(StemAnalysisResult *result);
+
+// Stats the stem files. Returns 0 on success, -1 if a file is missing or there
+// are more than STEM_ANALYSIS_MAX_STEMS.
+int StemAnalysisSourcesForPaths(const char *const *paths, size_t count, StemAnalysisSources *sources);
+
+// Sidecar I/O. Return 0 on success, -1 on I/O error, version mismatch or (on
+// read) a sidecar written for different sources or with out-of-range fields or
+// a size that doesn't match its beat count. Only write a sidecar for a result
+// every stem contributed to.
+int StemAnalysisWriteSidecar(const char *path, const StemAnalysisResult *result, const StemAnalysisSources *sources);
+int StemAnalysisReadSidecar(const char *path, const StemAnalysisSources *sources, StemAnalysisResult *result);
+
+// "A minor", "F# major" - static storage
+const char *StemAnalysisKeyName(int tonic, StemKeyMode mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
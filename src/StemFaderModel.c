@@ -0,0 +1,118 @@
+//
+//  StemFaderModel.c
+//  Display-rate fader view-model: touch-rate writes, one dirty-set per frame (portable C)
+//
+
+#include "StemFaderModel.h"
+#include "StemMixer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// Labels show whole percentages, so only a change of the rounded value retypes them
+static long DisplayedPercent(float value) {
+    return lrintf(value);
+}
+
+void StemFaderModelInit(StemFaderModel *model, size_t faderCount, float value, float valueResolution) {
+    memset(model, 0, sizeof(*model));
+    if (faderCount > STEM_FADER_MODEL_MAX_FADERS) faderCount = STEM_FADER_MODEL_MAX_FADERS;
+    model->faderCount = faderCount;
+    model->valueResolution = valueResolution;
+    for (size_t i = 0; i < faderCount; i++) {
+        model->pending[i].value = value;
+        model->published[i] = model->pending[i];
+    }
+}
+
+void StemFaderModelSetValue(StemFaderModel *model, size_t index, float value) {
+    if (index >= model->faderCount) return;
+    if (value < 0.0f) value = 0.0f;
+    if (value > STEM_MIXER_MAX_FADER) value = STEM_MIXER_MAX_FADER;
+    model->pending[index].value = value;
+    model->touched |= 1u << index;
+    model->inputCount++;
+}
+
+void StemFaderModelSetActive(StemFaderModel *model, size_t index, int active) {
+    if (index >= model->faderCount) return;
+    model->pending[index].active = active != 0;
+    model->touched |= 1u << index;
+    model->inputCount++;
+}
+
+void StemFaderModelSetMuted(StemFaderModel *model, size_t index, int muted) {
+    if (index >= model->faderCount) return;
+    model->pending[index].muted = muted != 0;
+    model->touched |= 1u << index;
+    model->inputCount++;
+}
+
+float StemFaderModelValue(const StemFaderModel *model, size_t index) {
+    return index < model->faderCount ? model->pending[index].value : 0.0f;
+}
+
+size_t StemFaderModelPublish(StemFaderModel *model, StemFaderFrame *frame) {
+    frame->count = 0;
+    frame->statusDirty = 0;
+    frame->coalescedInputs = model->inputCount;
+    model->inputCount = 0;
+
+    uint32_t touched = model->touched;
+    model->touched = 0;
+
+    for (size_t i = 0; touched; i++, touched >>= 1) {
+        if (!(touched & 1u)) continue;
+
+        StemFaderState *pending = &model->pending[i];
+        StemFaderState *published = &model->published[i];
+        uint8_t flags = 0;
+
+        // Sub-resolution moves are held back while the fader is held (and
+        // measured against the last published value, so slow drags still get
+        // through), except that the ends of the track and a change of displayed
+        // percentage always show. A held-back fader stays touched, and releasing
+        // it flushes the leftover so the knob never rests off its value.
+        float delta = fabsf(pending->value - published->value);
+        int labelChanged = DisplayedPercent(pending->value) != DisplayedPercent(published->value);
+        int atEnd = (pending->value == 0.0f || pending->value == STEM_MIXER_MAX_FADER) && delta > 0.0f;
+        int released = !pending->active && delta > 0.0f;
+        if (delta >= model->valueResolution || labelChanged || atEnd || released) {
+            flags |= StemFaderDirtyKnob;
+            if (labelChanged && !pending->muted) flags |= StemFaderDirtyLabel;
+            published->value = pending->value;
+        } else if (delta > 0.0f) {
+            model->touched |= 1u << i;
+        }
+        if (pending->active != published->active || pending->muted != published->muted) {
+            flags |= StemFaderDirtyStyle | StemFaderDirtyLabel;
+            published->active = pending->active;
+            published->muted = pending->muted;
+        }
+        if (!flags) continue;
+
+        frame->indices[frame->count] = (uint8_t)i;
+        frame->flags[frame->count] = flags;
+        frame->states[frame->count] = *published;
+        frame->count++;
+        if (flags & StemFaderDirtyLabel) frame->statusDirty = 1;
+    }
+    return frame->count;
+}
+
+size_t StemFaderModelFormatStatus(const StemFaderModel *model, char *buffer, size_t size) {
+    size_t length = 0;
+    if (size == 0) return 0;
+    buffer[0] = '\0';
+
+    for (size_t i = 0; i < model->faderCount && length < size; i++) {
+        const StemFaderState *state = &model->published[i];
+        int written = state->muted
+            ? snprintf(buffer + length, size - length, "F%zu: MUTE  ", i + 1)
+            : snprintf(buffer + length, size - length, "F%zu: %3ld%%  ", i + 1, DisplayedPercent(state->value));
+        if (written < 0) break;
+        length += (size_t)written;
+    }
+    return length < size ? length : size - 1;
+}
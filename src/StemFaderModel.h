@@ -0,0 +1,74 @@
+//
+//  StemFaderModel.h
+//  Display-rate fader view-model: touch-rate writes, one dirty-set per frame (portable C)
+//
+
+#ifndef STEM_FADER_MODEL_H
+#define STEM_FADER_MODEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STEM_FADER_MODEL_MAX_FADERS 8   // Matches MAX_POSSIBLE_FADERS
+
+// What a published fader needs redrawn
+enum {
+    StemFaderDirtyKnob  = 1 << 0,   // Value moved: knob and fill
+    StemFaderDirtyLabel = 1 << 1,   // Displayed percentage or mute tag changed
+    StemFaderDirtyStyle = 1 << 2,   // Active/muted colours changed: everything but the chrome
+};
+
+typedef struct {
+    float value;   // 0-100 fader scale
+    int active;
+    int muted;
+} StemFaderState;
+
+typedef struct {
+    size_t faderCount;
+    float valueResolution;                                  // Smallest value change worth a redraw
+    StemFaderState pending[STEM_FADER_MODEL_MAX_FADERS];    // Latest input, written at touch rate
+    StemFaderState published[STEM_FADER_MODEL_MAX_FADERS];  // What the UI currently shows
+    uint32_t touched;                                       // Faders written since the last publish
+    uint64_t inputCount;                                    // Writes since the last publish
+} StemFaderModel;
+
+typedef struct {
+    size_t count;                                           // Dirty faders this frame
+    uint8_t indices[STEM_FADER_MODEL_MAX_FADERS];
+    uint8_t flags[STEM_FADER_MODEL_MAX_FADERS];             // StemFaderDirty* per entry
+    StemFaderState states[STEM_FADER_MODEL_MAX_FADERS];
+    int statusDirty;                                        // Values summary text needs reformatting
+    uint64_t coalescedInputs;                               // Writes folded into this frame
+} StemFaderFrame;
+
+// All faders start at value, inactive and unmuted, and are already published.
+// valueResolution is in fader units (e.g. a track of 150 px over 0-100 wants ~0.5).
+void StemFaderModelInit(StemFaderModel *model, size_t faderCount, float value, float valueResolution);
+
+// Touch-rate writes. Cheap: no allocation, no formatting, no UI.
+void StemFaderModelSetValue(StemFaderModel *model, size_t index, float value);
+void StemFaderModelSetActive(StemFaderModel *model, size_t index, int active);
+void StemFaderModelSetMuted(StemFaderModel *model, size_t index, int muted);
+
+// Latest written value (what audio should follow), not the published one
+float StemFaderModelValue(const StemFaderModel *model, size_t index);
+
+// Call once per display frame. Compares pending against published for faders
+// written since the last call and reports each visibly changed fader once.
+// Faders with a held-back sub-resolution move stay pending until it shows.
+// Returns frame->count; 0 means there is nothing to redraw.
+size_t StemFaderModelPublish(StemFaderModel *model, StemFaderFrame *frame);
+
+// "F1:  50%  F2: MUTE  ..." from the published state. Returns the length written.
+size_t StemFaderModelFormatStatus(const StemFaderModel *model, char *buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,91 @@
+//
+//  StemMixer.c
+//  Fader/mute/automation mixing shared by the app and the batch renderer (portable C)
+//
+
+#include "StemMixer.h"
+
+#include <string.h>
+
+float StemMixerGainForFader(float value, int muted) {
+    if (muted) return 0.0f;
+    if (value < 0.0f) value = 0.0f;
+    if (value > STEM_MIXER_MAX_FADER) value = STEM_MIXER_MAX_FADER;
+    return value / STEM_MIXER_MAX_FADER;
+}
+
+float StemMixerChannelValueAt(const StemMixerChannel *channel, double seconds) {
+    size_t count = channel->automationCount;
+    const StemMixerPoint *points = channel->automation;
+    if (!points || count == 0) return channel->value;
+    if (seconds <= points[0].time) return points[0].value;
+    if (seconds >= points[count - 1].time) return points[count - 1].value;
+
+    // Binary search for the segment containing `seconds`
+    size_t lo = 0, hi = count - 1;
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (points[mid].time <= seconds) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    double span = points[hi].time - points[lo].time;
+    double t = span > 0.0 ? (seconds - points[lo].time) / span : 1.0;
+    return (float)(points[lo].value + t * (points[hi].value - points[lo].value));
+}
+
+void StemMixerMixBlock(const StemMixerChannel *channels,
+                       const float *const *inputs,
+                       const uint16_t *inputChannels,
+                       const size_t *inputFrames,
+                       size_t stemCount,
+                       float *output,
+                       uint16_t outputChannels,
+                       size_t frameCount,
+                       double startSeconds,
+                       double sampleRate) {
+    memset(output, 0, frameCount * outputChannels * sizeof(float));
+    if (frameCount == 0) return;
+
+    double endSeconds = startSeconds + frameCount / sampleRate;
+
+    for (size_t s = 0; s < stemCount; s++) {
+        const StemMixerChannel *channel = &channels[s];
+        float startGain = StemMixerGainForFader(StemMixerChannelValueAt(channel, startSeconds), channel->muted);
+        float endGain = StemMixerGainForFader(StemMixerChannelValueAt(channel, endSeconds), channel->muted);
+        if (startGain == 0.0f && endGain == 0.0f) continue;
+
+        const float *in = inputs[s];
+        uint16_t inChannels = inputChannels[s];
+        size_t frames = inputFrames[s] < frameCount ? inputFrames[s] : frameCount;
+        float step = (endGain - startGain) / (float)frameCount;
+
+        if (inChannels == outputChannels) {
+            size_t samples = frames * outputChannels;
+            if (step == 0.0f) {
+                for (size_t i = 0; i < samples; i++) output[i] += startGain * in[i];
+            } else {
+                for (size_t f = 0; f < frames; f++) {
+                    float gain = startGain + step * (float)f;
+                    for (uint16_t c = 0; c < outputChannels; c++) {
+                        output[f * outputChannels + c] += gain * in[f * outputChannels + c];
+                    }
+                }
+            }
+        } else {
+            // Mono fans out to every channel; otherwise map channel-for-channel and drop extras
+            for (size_t f = 0; f < frames; f++) {
+                float gain = startGain + step * (float)f;
+                for (uint16_t c = 0; c < outputChannels; c++) {
+                    uint16_t source = inChannels == 1 ? 0 : c;
+                    if (source < inChannels) {
+                        output[f * outputChannels + c] += gain * in[f * inChannels + source];
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,57 @@
+//
+//  StemMixer.h
+//  Fader/mute/automation mixing shared by the app and the batch renderer (portable C)
+//
+
+#ifndef STEM_MIXER_H
+#define STEM_MIXER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STEM_MIXER_MAX_STEMS 8          // Matches MAX_POSSIBLE_FADERS
+#define STEM_MIXER_DEFAULT_FADER 50.0f  // Faders start (and reset) at the centre
+#define STEM_MIXER_MAX_FADER 100.0f
+
+// Automation breakpoint: fader position at a time, linear in between
+typedef struct {
+    double time;   // Seconds
+    float value;   // 0-100, fader scale
+} StemMixerPoint;
+
+typedef struct {
+    float value;                         // 0-100 fader position, used without automation
+    int muted;
+    const StemMixerPoint *automation;    // Sorted by time, or NULL
+    size_t automationCount;
+} StemMixerChannel;
+
+// Linear gain for a fader position - the same mapping the app applies to AVAudioPlayerNode.volume
+float StemMixerGainForFader(float value, int muted);
+
+// Fader position at a song time, following automation if present
+float StemMixerChannelValueAt(const StemMixerChannel *channel, double seconds);
+
+// Sums one block of stems into output (overwritten). Stem i supplies inputFrames[i]
+// interleaved frames with inputChannels[i] channels; missing frames are silence.
+// Mono stems feed every output channel. Gains ramp linearly across the block.
+void StemMixerMixBlock(const StemMixerChannel *channels,
+                       const float *const *inputs,
+                       const uint16_t *inputChannels,
+                       const size_t *inputFrames,
+                       size_t stemCount,
+                       float *output,
+                       uint16_t outputChannels,
+                       size_t frameCount,
+                       double startSeconds,
+                       double sampleRate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,32 @@
+//
+//  StemSeekDecoder.h
+//  Random-access MP3 stem decoding driven by a StemSeekTable
+//
+
+#import <Foundation/Foundation.h>
+#import <AVFoundation/AVFoundation.h>
+#import "StemSeekTable.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface StemSeekDecoder : NSObject
+
+// Deinterleaved float at the stem's rate - matches AVAudioFile.processingFormat
+@property (nonatomic, readonly) AVAudioFormat *format;
+// Playable samples after encoder delay/padding trim
+@property (nonatomic, readonly) AVAudioFramePosition length;
+
+// Loads <path>.seek, building it first if needed. Returns nil for non-MP3 stems.
+- (nullable instancetype)initWithPath:(NSString *)path;
+
+// Decodes frameCount samples starting exactly at position. Only the frames the
+// target depends on (bit reservoir + IMDCT overlap) are decoded.
+- (nullable AVAudioPCMBuffer *)readFrames:(AVAudioFrameCount)frameCount atPosition:(AVAudioFramePosition)position;
+
+// YES if the file has the same format and length and plays the same samples at
+// the same positions, so scrub grains line up with AVAudioFile playback.
+- (BOOL)matchesAudioFile:(AVAudioFile *)file;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,194 @@
+//
+//  StemSeekDecoder.m
+//  Random-access MP3 stem decoding driven by a StemSeekTable
+//
+
+#import "StemSeekDecoder.h"
+#import <AudioToolbox/AudioToolbox.h>
+
+// Feeds whole MP3 frames to the converter, one packet per callback
+typedef struct {
+    const uint8_t *bytes;
+    const StemSeekTable *table;
+    uint32_t nextFrame;
+    AudioStreamPacketDescription packet;
+} StemPacketFeed;
+
+static OSStatus StemPacketFeedCallback(AudioConverterRef converter,
+                                       UInt32 *ioNumberDataPackets,
+                                       AudioBufferList *ioData,
+                                       AudioStreamPacketDescription **outPacketDescription,
+                                       void *userData) {
+    StemPacketFeed *feed = userData;
+    const StemSeekTable *table = feed->table;
+
+    if (feed->nextFrame >= table->frameCount) {
+        *ioNumberDataPackets = 0;  // End of stream
+        return noErr;
+    }
+
+    uint32_t start = table->frameOffsets[feed->nextFrame];
+    uint32_t size = table->frameOffsets[feed->nextFrame + 1] - start;
+    feed->nextFrame++;
+
+    feed->packet.mStartOffset = 0;
+    feed->packet.mVariableFramesInPacket = 0;
+    feed->packet.mDataByteSize = size;
+
+    ioData->mNumberBuffers = 1;
+    ioData->mBuffers[0].mData = (void *)(feed->bytes + start);
+    ioData->mBuffers[0].mDataByteSize = size;
+    ioData->mBuffers[0].mNumberChannels = table->channelCount;
+    if (outPacketDescription) {
+        *outPacketDescription = &feed->packet;
+    }
+    *ioNumberDataPackets = 1;
+    return noErr;
+}
+
+@implementation StemSeekDecoder {
+    NSData *_data;
+    StemSeekTable _table;
+    AudioConverterRef _converter;
+    AVAudioPCMBuffer *_scratch;  // Holds discarded warm-up output plus the requested frames
+    AudioBufferList *_fillList;
+}
+
+- (instancetype)initWithPath:(NSString *)path {
+    self = [super init];
+    if (self) {
+        if (StemSeekTableLoadOrBuild(path.fileSystemRepresentation, &_table) != 0) {
+            return nil;
+        }
+
+        _data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:nil];
+        if (!_data) {
+            return nil;
+        }
+
+        _format = [[AVAudioFormat alloc] initStandardFormatWithSampleRate:_table.sampleRate
+                                                                 channels:_table.channelCount];
+        _length = (AVAudioFramePosition)_table.sampleCount;
+
+        AudioStreamBasicDescription input = {0};
+        input.mSampleRate = _table.sampleRate;
+        input.mFormatID = kAudioFormatMPEGLayer3;
+        input.mFramesPerPacket = _table.samplesPerFrame;
+        input.mChannelsPerFrame = _table.channelCount;
+
+        OSStatus status = AudioConverterNew(&input, _format.streamDescription, &_converter);
+        if (status != noErr) {
+            NSLog(@"StemSeekDecoder: no MP3 converter for %@ (%d)", path.lastPathComponent, (int)status);
+            return nil;
+        }
+
+        // The seek table accounts for decoder delay itself; the converter must
+        // emit exactly one frame of output per packet from the first packet.
+        UInt32 primeMethod = kConverterPrimeMethod_None;
+        AudioConverterSetProperty(_converter, kAudioConverterPrimeMethod, sizeof(primeMethod), &primeMethod);
+
+        _fillList = calloc(1, offsetof(AudioBufferList, mBuffers) + sizeof(AudioBuffer) * _table.channelCount);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_converter) {
+        AudioConverterDispose(_converter);
+    }
+    free(_fillList);
+    StemSeekTableFree(&_table);
+}
+
+- (AVAudioPCMBuffer *)readFrames:(AVAudioFrameCount)frameCount atPosition:(AVAudioFramePosition)position {
+    if (position < 0 || position >= _length || frameCount == 0) {
+        return nil;
+    }
+    frameCount = (AVAudioFrameCount)MIN((AVAudioFramePosition)frameCount, _length - position);
+
+    StemSeekPoint point;
+    if (StemSeekTableLocate(&_table, (uint64_t)position, &point) != 0) {
+        return nil;
+    }
+
+    AVAudioFrameCount needed = point.discardSamples + frameCount;
+    if (!_scratch || _scratch.frameCapacity < needed) {
+        _scratch = [[AVAudioPCMBuffer alloc] initWithPCMFormat:_format frameCapacity:needed];
+    }
+
+    AudioConverterReset(_converter);
+    StemPacketFeed feed = { _data.bytes, &_table, point.decodeFrame, {0} };
+
+    AVAudioFrameCount decoded = 0;
+    UInt32 channels = _table.channelCount;
+    _fillList->mNumberBuffers = channels;
+    while (decoded < needed) {
+        for (UInt32 c = 0; c < channels; c++) {
+            _fillList->mBuffers[c].mNumberChannels = 1;
+            _fillList->mBuffers[c].mData = _scratch.floatChannelData[c] + decoded;
+            _fillList->mBuffers[c].mDataByteSize = (needed - decoded) * sizeof(float);
+        }
+
+        UInt32 packets = needed - decoded;
+        OSStatus status = AudioConverterFillComplexBuffer(_converter, StemPacketFeedCallback, &feed,
+                                                          &packets, _fillList, NULL);
+        if (status != noErr || packets == 0) {
+            break;
+        }
+        decoded += packets;
+    }
+
+    if (decoded <= point.discardSamples) {
+        return nil;
+    }
+
+    AVAudioFrameCount available = MIN(frameCount, decoded - point.discardSamples);
+    AVAudioPCMBuffer *buffer = [[AVAudioPCMBuffer alloc] initWithPCMFormat:_format frameCapacity:available];
+    for (UInt32 c = 0; c < channels; c++) {
+        memcpy(buffer.floatChannelData[c], _scratch.floatChannelData[c] + point.discardSamples,
+               available * sizeof(float));
+    }
+    buffer.frameLength = available;
+    return buffer;
+}
+
+- (BOOL)matchesAudioFile:(AVAudioFile *)file {
+    if (file.length != _length || ![file.processingFormat isEqual:_format]) {
+        return NO;
+    }
+
+    // Probe a few positions; a sample of offset on audible material exceeds the
+    // tolerance, while the same Core Audio decoder on both sides stays well below it
+    const AVAudioFrameCount probe = 4096;
+    const float tolerance = 1e-4f;
+    AVAudioPCMBuffer *reference = [[AVAudioPCMBuffer alloc] initWithPCMFormat:_format frameCapacity:probe];
+    AVAudioFramePosition saved = file.framePosition;
+    BOOL matches = YES;
+    for (NSInteger quarter = 1; quarter <= 3 && matches; quarter++) {
+        AVAudioFramePosition position = _length * quarter / 4;
+        AVAudioFrameCount count = (AVAudioFrameCount)MIN((AVAudioFramePosition)probe, _length - position);
+        if (count == 0) {
+            continue;
+        }
+
+        file.framePosition = position;
+        AVAudioPCMBuffer *decoded = [self readFrames:count atPosition:position];
+        if (![file readIntoBuffer:reference frameCount:count error:nil] || reference.frameLength != count ||
+            decoded.frameLength != count) {
+            matches = NO;
+            break;
+        }
+        for (UInt32 c = 0; c < _table.channelCount && matches; c++) {
+            for (AVAudioFrameCount i = 0; i < count; i++) {
+                if (fabsf(reference.floatChannelData[c][i] - decoded.floatChannelData[c][i]) > tolerance) {
+                    matches = NO;
+                    break;
+                }
+            }
+        }
+    }
+    file.framePosition = saved;
+    return matches;
+}
+
+@end
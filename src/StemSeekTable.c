@@ -0,0 +1,380 @@
+//
+//  StemSeekTable.c
+//  Per-stem MP3 seek index for sample-accurate seeking (portable C)
+//
+
+#include "StemSeekTable.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define SIDECAR_MAGIC "STSK"
+#define SIDECAR_VERSION 3
+#define SIDECAR_HEADER_SIZE 52
+
+typedef struct {
+    int mpeg1;
+    uint32_t sampleRate;
+    uint16_t channelCount;
+    uint16_t samplesPerFrame;
+    uint32_t frameSize;
+    uint32_t sideInfoOffset;   // Header + optional CRC
+    uint32_t sideInfoSize;
+} FrameHeader;
+
+static const uint16_t kBitratesMPEG1[16] = {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0};
+static const uint16_t kBitratesMPEG2[16] = {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0};
+static const uint32_t kSampleRates[3] = {44100, 48000, 32000};
+
+// Parses a Layer III header. Free-format and reserved values are rejected.
+static int ParseHeader(const uint8_t *p, size_t available, FrameHeader *header) {
+    if (available < 4 || p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) return 0;
+
+    int version = (p[1] >> 3) & 3;     // 0 = 2.5, 2 = 2, 3 = 1
+    int layer = (p[1] >> 1) & 3;       // 1 = Layer III
+    int bitrateIndex = p[2] >> 4;
+    int rateIndex = (p[2] >> 2) & 3;
+    if (version == 1 || layer != 1 || bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3) return 0;
+
+    header->mpeg1 = (version == 3);
+    header->sampleRate = kSampleRates[rateIndex] >> (version == 3 ? 0 : version == 2 ? 1 : 2);
+    header->channelCount = ((p[3] >> 6) == 3) ? 1 : 2;
+    header->samplesPerFrame = header->mpeg1 ? 1152 : 576;
+
+    uint32_t bitrate = (header->mpeg1 ? kBitratesMPEG1 : kBitratesMPEG2)[bitrateIndex] * 1000u;
+    uint32_t padding = (p[2] >> 1) & 1;
+    header->frameSize = (header->mpeg1 ? 144u : 72u) * bitrate / header->sampleRate + padding;
+
+    header->sideInfoOffset = (p[1] & 1) ? 4 : 6;
+    if (header->mpeg1) {
+        header->sideInfoSize = header->channelCount == 1 ? 17 : 32;
+    } else {
+        header->sideInfoSize = header->channelCount == 1 ? 9 : 17;
+    }
+    return header->frameSize > header->sideInfoOffset + header->sideInfoSize;
+}
+
+static uint32_t MainDataBegin(const uint8_t *frame, const FrameHeader *header) {
+    const uint8_t *side = frame + header->sideInfoOffset;
+    return header->mpeg1 ? ((uint32_t)side[0] << 1) | (side[1] >> 7) : side[0];
+}
+
+static uint32_t ReadBE32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// Detects a Xing/Info frame and pulls gapless delay/padding from its LAME tag.
+// Returns 1 if the frame carries no audio.
+static int ParseInfoFrame(const uint8_t *frame, const FrameHeader *header, StemSeekTable *table) {
+    const uint8_t *xing = frame + header->sideInfoOffset + header->sideInfoSize;
+    const uint8_t *end = frame + header->frameSize;
+
+    if (xing + 8 <= end && (memcmp(xing, "Xing", 4) == 0 || memcmp(xing, "Info", 4) == 0)) {
+        uint32_t flags = ReadBE32(xing + 4);
+        const uint8_t *lame = xing + 8;
+        if (flags & 0x1) lame += 4;    // Frame count
+        if (flags & 0x2) lame += 4;    // Byte count
+        if (flags & 0x4) lame += 100;  // TOC
+        if (flags & 0x8) lame += 4;    // Quality
+
+        if (lame + 24 <= end && (memcmp(lame, "LAME", 4) == 0 || memcmp(lame, "Lavc", 4) == 0 ||
+                                 memcmp(lame, "Lavf", 4) == 0 || memcmp(lame, "GOGO", 4) == 0)) {
+            const uint8_t *gapless = lame + 21;
+            table->encoderDelay = ((uint32_t)gapless[0] << 4) | (gapless[1] >> 4);
+            table->encoderPadding = ((uint32_t)(gapless[1] & 0x0F) << 8) | gapless[2];
+        }
+        return 1;
+    }
+
+    // Fraunhofer VBRI header sits at a fixed offset
+    const uint8_t *vbri = frame + 36;
+    return vbri + 4 <= end && memcmp(vbri, "VBRI", 4) == 0;
+}
+
+static size_t SkipID3v2(const uint8_t *data, size_t size) {
+    if (size < 10 || memcmp(data, "ID3", 3) != 0) return 0;
+    size_t tagSize = ((size_t)(data[6] & 0x7F) << 21) | ((size_t)(data[7] & 0x7F) << 14) |
+                     ((size_t)(data[8] & 0x7F) << 7) | (data[9] & 0x7F);
+    size_t total = 10 + tagSize + ((data[5] & 0x10) ? 10 : 0);
+    return total < size ? total : size;
+}
+
+int StemSeekTableBuild(const uint8_t *data, size_t size, StemSeekTable *table) {
+    memset(table, 0, sizeof(*table));
+
+    size_t capacity = 1024;
+    uint32_t *offsets = malloc((capacity + 1) * sizeof(uint32_t));
+    uint8_t *reservoir = malloc(capacity);
+    uint16_t *mainDataSizes = malloc(capacity * sizeof(uint16_t));
+    if (!offsets || !reservoir || !mainDataSizes) goto fail;
+
+    size_t pos = SkipID3v2(data, size);
+    size_t audioEnd = pos;  // End of the last accepted frame; trailing tags are excluded
+    uint32_t count = 0;
+    int sawFirstFrame = 0;
+    FrameHeader header;
+
+    while (pos + 4 <= size) {
+        if (!ParseHeader(data + pos, size - pos, &header) || pos + header.frameSize > size) {
+            pos++;
+            continue;
+        }
+
+        if (!sawFirstFrame) {
+            // Guard against false sync inside junk: the next header must agree
+            FrameHeader next;
+            size_t nextPos = pos + header.frameSize;
+            if (nextPos + 4 <= size && (!ParseHeader(data + nextPos, size - nextPos, &next) ||
+                                        next.sampleRate != header.sampleRate)) {
+                pos++;
+                continue;
+            }
+            sawFirstFrame = 1;
+            table->sampleRate = header.sampleRate;
+            table->channelCount = header.channelCount;
+            table->samplesPerFrame = header.samplesPerFrame;
+            if (ParseInfoFrame(data + pos, &header, table)) {
+                pos += header.frameSize;
+                continue;
+            }
+        } else if (header.sampleRate != table->sampleRate || header.samplesPerFrame != table->samplesPerFrame) {
+            pos++;
+            continue;
+        }
+
+        if (count == capacity) {
+            capacity *= 2;
+            uint32_t *grownOffsets = realloc(offsets, (capacity + 1) * sizeof(uint32_t));
+            if (grownOffsets) offsets = grownOffsets;
+            uint8_t *grownReservoir = realloc(reservoir, capacity);
+            if (grownReservoir) reservoir = grownReservoir;
+            uint16_t *grownSizes = realloc(mainDataSizes, capacity * sizeof(uint16_t));
+            if (grownSizes) mainDataSizes = grownSizes;
+            if (!grownOffsets || !grownReservoir || !grownSizes) goto fail;
+        }
+
+        // Count the preceding frames whose main data this frame starts in
+        uint32_t needed = MainDataBegin(data + pos, &header);
+        uint32_t borrowed = 0;
+        while (needed > 0 && borrowed < count && borrowed < 255) {
+            uint16_t available = mainDataSizes[count - 1 - borrowed];
+            borrowed++;
+            needed = needed > available ? needed - available : 0;
+        }
+
+        offsets[count] = (uint32_t)pos;
+        reservoir[count] = (uint8_t)borrowed;
+        mainDataSizes[count] = (uint16_t)(header.frameSize - header.sideInfoOffset - header.sideInfoSize);
+        count++;
+        pos += header.frameSize;
+        audioEnd = pos;
+    }
+
+    if (count == 0) goto fail;
+
+    offsets[count] = (uint32_t)audioEnd;
+    table->frameCount = count;
+    table->frameOffsets = offsets;
+    table->reservoirFrames = reservoir;
+    table->primingSamples = table->encoderDelay + STEM_SEEK_DECODER_DELAY;
+
+    uint64_t decoded = (uint64_t)count * table->samplesPerFrame;
+    uint64_t trimmed = table->encoderDelay + table->encoderPadding;
+    if (trimmed == 0) trimmed = STEM_SEEK_DECODER_DELAY;
+    table->sampleCount = decoded > trimmed ? decoded - trimmed : 0;
+
+    free(mainDataSizes);
+    return 0;
+
+fail:
+    free(offsets);
+    free(reservoir);
+    free(mainDataSizes);
+    memset(table, 0, sizeof(*table));
+    return -1;
+}
+
+void StemSeekTableFree(StemSeekTable *table) {
+    free(table->frameOffsets);
+    free(table->reservoirFrames);
+    memset(table, 0, sizeof(*table));
+}
+
+int StemSeekTableLocate(const StemSeekTable *table, uint64_t sample, StemSeekPoint *point) {
+    if (sample >= table->sampleCount) return -1;
+
+    uint64_t decodedIndex = sample + table->primingSamples;
+    uint32_t target = (uint32_t)(decodedIndex / table->samplesPerFrame);
+    if (target >= table->frameCount) return -1;
+
+    // The target needs its reservoir frames; its IMDCT overlap and synthesis
+    // history come from the previous frame, which in turn needs that frame's
+    // reservoir. A 576-sample frame is a single granule, so the previous frame's
+    // own overlap reaches back one frame further.
+    uint32_t start = target - table->reservoirFrames[target];
+    for (uint32_t back = 1; back <= (table->samplesPerFrame == 576 ? 2u : 1u) && back <= target; back++) {
+        uint32_t earlier = target - back - table->reservoirFrames[target - back];
+        if (earlier < start) start = earlier;
+    }
+
+    point->decodeFrame = start;
+    point->targetFrame = target;
+    point->byteOffset = table->frameOffsets[start];
+    point->discardSamples = (target - start) * table->samplesPerFrame +
+                            (uint32_t)(decodedIndex % table->samplesPerFrame);
+    return 0;
+}
+
+#pragma mark - Sidecar
+
+static void PutLE16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void PutLE32(uint8_t *p, uint32_t v) {
+    PutLE16(p, (uint16_t)v);
+    PutLE16(p + 2, (uint16_t)(v >> 16));
+}
+
+static void PutLE64(uint8_t *p, uint64_t v) {
+    PutLE32(p, (uint32_t)v);
+    PutLE32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint16_t GetLE16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t GetLE32(const uint8_t *p) {
+    return GetLE16(p) | ((uint32_t)GetLE16(p + 2) << 16);
+}
+
+static uint64_t GetLE64(const uint8_t *p) {
+    return GetLE32(p) | ((uint64_t)GetLE32(p + 4) << 32);
+}
+
+// magic, version, source size, sampleRate, channels, samplesPerFrame, delay,
+// padding, sampleCount, frameCount, source mtime, then frameCount + 1 offsets
+// and frameCount reservoir counts
+int StemSeekTableWriteSidecar(const char *path, const StemSeekTable *table, uint64_t sourceSize,
+                              int64_t sourceModified) {
+    size_t size = SIDECAR_HEADER_SIZE + ((size_t)table->frameCount + 1) * 4 + table->frameCount;
+    uint8_t *buffer = malloc(size);
+    if (!buffer) return -1;
+
+    memcpy(buffer, SIDECAR_MAGIC, 4);
+    PutLE32(buffer + 4, SIDECAR_VERSION);
+    PutLE64(buffer + 8, sourceSize);
+    PutLE32(buffer + 16, table->sampleRate);
+    PutLE16(buffer + 20, table->channelCount);
+    PutLE16(buffer + 22, table->samplesPerFrame);
+    PutLE32(buffer + 24, table->encoderDelay);
+    PutLE32(buffer + 28, table->encoderPadding);
+    PutLE64(buffer + 32, table->sampleCount);
+    PutLE32(buffer + 40, table->frameCount);
+    PutLE64(buffer + 44, (uint64_t)sourceModified);
+
+    uint8_t *cursor = buffer + SIDECAR_HEADER_SIZE;
+    for (uint32_t i = 0; i <= table->frameCount; i++, cursor += 4) {
+        PutLE32(cursor, table->frameOffsets[i]);
+    }
+    memcpy(cursor, table->reservoirFrames, table->frameCount);
+
+    // Write-then-rename so a concurrent reader never sees a partial table
+    char tempPath[4096];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+    FILE *file = fopen(tempPath, "wb");
+    int ok = file && fwrite(buffer, 1, size, file) == size;
+    if (file) ok = (fclose(file) == 0) && ok;
+    free(buffer);
+
+    if (!ok || rename(tempPath, path) != 0) {
+        remove(tempPath);
+        return -1;
+    }
+    return 0;
+}
+
+int StemSeekTableReadSidecar(const char *path, StemSeekTable *table, uint64_t sourceSize,
+                             int64_t sourceModified) {
+    memset(table, 0, sizeof(*table));
+
+    FILE *file = fopen(path, "rb");
+    if (!file) return -1;
+
+    uint8_t header[SIDECAR_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, SIDECAR_MAGIC, 4) != 0 || GetLE32(header + 4) != SIDECAR_VERSION ||
+        GetLE64(header + 8) != sourceSize || (int64_t)GetLE64(header + 44) != sourceModified) {
+        fclose(file);
+        return -1;
+    }
+
+    table->sampleRate = GetLE32(header + 16);
+    table->channelCount = GetLE16(header + 20);
+    table->samplesPerFrame = GetLE16(header + 22);
+    table->encoderDelay = GetLE32(header + 24);
+    table->encoderPadding = GetLE32(header + 28);
+    table->sampleCount = GetLE64(header + 32);
+    table->frameCount = GetLE32(header + 40);
+    table->primingSamples = table->encoderDelay + STEM_SEEK_DECODER_DELAY;
+
+    size_t payloadSize = ((size_t)table->frameCount + 1) * 4 + table->frameCount;
+    uint8_t *payload = malloc(payloadSize);
+    table->frameOffsets = malloc(((size_t)table->frameCount + 1) * sizeof(uint32_t));
+    table->reservoirFrames = malloc((size_t)table->frameCount + 1);
+    int ok = payload && table->frameOffsets && table->reservoirFrames && table->frameCount > 0 &&
+             (table->samplesPerFrame == 1152 || table->samplesPerFrame == 576) &&
+             fread(payload, 1, payloadSize, file) == payloadSize;
+    fclose(file);
+
+    if (!ok) {
+        free(payload);
+        StemSeekTableFree(table);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i <= table->frameCount; i++) {
+        table->frameOffsets[i] = GetLE32(payload + i * 4);
+    }
+    memcpy(table->reservoirFrames, payload + ((size_t)table->frameCount + 1) * 4, table->frameCount);
+    free(payload);
+    return 0;
+}
+
+int StemSeekTableLoadOrBuild(const char *stemPath, StemSeekTable *table) {
+    // Size and mtime of the open file, so a stem replaced by one of the same
+    // size (a re-download) still invalidates the sidecar
+    FILE *file = fopen(stemPath, "rb");
+    struct stat info;
+    if (!file || fstat(fileno(file), &info) != 0 || info.st_size <= 0) {
+        if (file) fclose(file);
+        return -1;
+    }
+    size_t size = (size_t)info.st_size;
+    int64_t modified = (int64_t)info.st_mtime;
+
+    char sidecarPath[4096];
+    snprintf(sidecarPath, sizeof(sidecarPath), "%s%s", stemPath, STEM_SEEK_SIDECAR_EXTENSION);
+    if (StemSeekTableReadSidecar(sidecarPath, table, size, modified) == 0) {
+        fclose(file);
+        return 0;
+    }
+
+    uint8_t *data = malloc(size);
+    int ok = data && fread(data, 1, size, file) == size;
+    fclose(file);
+    if (!ok || StemSeekTableBuild(data, size, table) != 0) {
+        free(data);
+        return -1;
+    }
+    free(data);
+
+    if (StemSeekTableWriteSidecar(sidecarPath, table, size, modified) != 0) {
+        fprintf(stderr, "StemSeekTable: could not write %s\n", sidecarPath);
+    }
+    return 0;
+}
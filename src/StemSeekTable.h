@@ -0,0 +1,70 @@
+//
+//  StemSeekTable.h
+//  Per-stem MP3 seek index for sample-accurate seeking (portable C)
+//
+//  The table records the byte offset of every Layer III frame, how many
+//  preceding frames each one borrows bit-reservoir data from, and the
+//  encoder delay/padding from the LAME tag. Any sample position maps to a
+//  decode start frame plus a discard count in O(1), so all stems can seek
+//  to the same sample by decoding only a handful of frames.
+//
+
+#ifndef STEM_SEEK_TABLE_H
+#define STEM_SEEK_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sidecar lives next to the stem: drums.mp3 -> drums.mp3.seek
+#define STEM_SEEK_SIDECAR_EXTENSION ".seek"
+
+// Synthesis filterbank delay shared by all Layer III decoders
+#define STEM_SEEK_DECODER_DELAY 529
+
+typedef struct {
+    uint32_t sampleRate;
+    uint16_t channelCount;
+    uint16_t samplesPerFrame;  // 1152 (MPEG-1) or 576 (MPEG-2/2.5)
+    uint32_t encoderDelay;     // From the LAME/Lavc tag, 0 if absent
+    uint32_t encoderPadding;
+    uint32_t primingSamples;   // Decoder output dropped before sample 0
+    uint64_t sampleCount;      // Playable samples after priming/padding trim
+    uint32_t frameCount;       // Audio frames (the Xing/Info frame is excluded)
+    uint32_t *frameOffsets;    // frameCount + 1 entries; the last is the end of audio
+    uint8_t *reservoirFrames;  // Preceding frames holding part of each frame's main data
+} StemSeekTable;
+
+typedef struct {
+    uint32_t decodeFrame;      // First frame to feed a freshly reset decoder
+    uint32_t targetFrame;      // Frame containing the requested sample
+    uint32_t byteOffset;       // frameOffsets[decodeFrame]
+    uint32_t discardSamples;   // Decoder output to drop before the requested sample
+} StemSeekPoint;
+
+// Scans an in-memory MP3. Returns 0 on success, -1 if no Layer III frames are found.
+int StemSeekTableBuild(const uint8_t *data, size_t size, StemSeekTable *table);
+void StemSeekTableFree(StemSeekTable *table);
+
+// O(1): where to start decoding so that, after discarding, output begins at `sample`.
+// Returns -1 if the sample is past the end.
+int StemSeekTableLocate(const StemSeekTable *table, uint64_t sample, StemSeekPoint *point);
+
+// Sidecar I/O. The source size and mtime (seconds) are stored so a re-downloaded
+// stem invalidates it; reading fails unless both match.
+int StemSeekTableWriteSidecar(const char *path, const StemSeekTable *table, uint64_t sourceSize,
+                              int64_t sourceModified);
+int StemSeekTableReadSidecar(const char *path, StemSeekTable *table, uint64_t sourceSize,
+                             int64_t sourceModified);
+
+// Reads "<stemPath>.seek", or scans the stem and writes it. Returns 0 on success.
+int StemSeekTableLoadOrBuild(const char *stemPath, StemSeekTable *table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,251 @@
+//
+//  StemWav.c
+//  Minimal streaming RIFF/WAVE reader and writer for stem files (portable C)
+//
+
+#include "StemWav.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t ReadLE32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t ReadLE16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+int StemWavReaderOpen(StemWavReader *reader, const char *path) {
+    memset(reader, 0, sizeof(*reader));
+
+    FILE *file = fopen(path, "rb");
+    if (!file) return -1;
+
+    uint8_t header[12];
+    if (fread(header, 1, 12, file) != 12 || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+        fclose(file);
+        return -1;
+    }
+
+    int haveFormat = 0;
+    for (;;) {
+        uint8_t chunk[8];
+        if (fread(chunk, 1, 8, file) != 8) break;
+        uint32_t chunkSize = ReadLE32(chunk + 4);
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t fmt[40];
+            size_t toRead = chunkSize < sizeof(fmt) ? chunkSize : sizeof(fmt);
+            if (toRead < 16 || fread(fmt, 1, toRead, file) != toRead) break;
+            reader->formatTag = ReadLE16(fmt);
+            reader->channelCount = ReadLE16(fmt + 2);
+            reader->sampleRate = ReadLE32(fmt + 4);
+            reader->bitsPerSample = ReadLE16(fmt + 14);
+            // WAVE_FORMAT_EXTENSIBLE carries the real tag in the sub-format GUID
+            if (reader->formatTag == 0xFFFE && toRead >= 26) {
+                reader->formatTag = ReadLE16(fmt + 24);
+            }
+            fseek(file, (long)(chunkSize - toRead + (chunkSize & 1)), SEEK_CUR);
+            haveFormat = 1;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!haveFormat || reader->channelCount == 0) break;
+            if (!((reader->formatTag == 1 && (reader->bitsPerSample == 16 || reader->bitsPerSample == 24 || reader->bitsPerSample == 32)) ||
+                  (reader->formatTag == 3 && reader->bitsPerSample == 32))) {
+                break;
+            }
+            uint32_t bytesPerFrame = reader->channelCount * (reader->bitsPerSample / 8);
+            reader->file = file;
+            reader->frameCount = chunkSize / bytesPerFrame;
+            reader->framesRemaining = reader->frameCount;
+            return 0;
+        } else {
+            fseek(file, (long)(chunkSize + (chunkSize & 1)), SEEK_CUR);
+        }
+    }
+
+    fclose(file);
+    memset(reader, 0, sizeof(*reader));
+    return -1;
+}
+
+size_t StemWavReaderRead(StemWavReader *reader, float *interleaved, size_t maxFrames) {
+    if (!reader->file || reader->framesRemaining == 0) return 0;
+
+    size_t frames = maxFrames < reader->framesRemaining ? maxFrames : (size_t)reader->framesRemaining;
+    size_t bytesPerSample = reader->bitsPerSample / 8;
+    size_t sampleCount = frames * reader->channelCount;
+    size_t byteCount = sampleCount * bytesPerSample;
+
+    if (reader->scratchSize < byteCount) {
+        uint8_t *scratch = realloc(reader->scratch, byteCount);
+        if (!scratch) return 0;
+        reader->scratch = scratch;
+        reader->scratchSize = byteCount;
+    }
+
+    size_t bytesRead = fread(reader->scratch, 1, byteCount, reader->file);
+    frames = bytesRead / (bytesPerSample * reader->channelCount);
+    sampleCount = frames * reader->channelCount;
+    reader->framesRemaining = frames ? reader->framesRemaining - frames : 0;
+
+    const uint8_t *src = reader->scratch;
+    if (reader->formatTag == 3) {
+        for (size_t i = 0; i < sampleCount; i++) {
+            uint32_t bits = ReadLE32(src + i * 4);
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            interleaved[i] = value;
+        }
+    } else if (reader->bitsPerSample == 16) {
+        for (size_t i = 0; i < sampleCount; i++) {
+            interleaved[i] = (int16_t)ReadLE16(src + i * 2) * (1.0f / 32768.0f);
+        }
+    } else if (reader->bitsPerSample == 24) {
+        for (size_t i = 0; i < sampleCount; i++) {
+            const uint8_t *p = src + i * 3;
+            int32_t value = (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24) >> 8;
+            interleaved[i] = value * (1.0f / 8388608.0f);
+        }
+    } else {
+        for (size_t i = 0; i < sampleCount; i++) {
+            interleaved[i] = (int32_t)ReadLE32(src + i * 4) * (1.0f / 2147483648.0f);
+        }
+    }
+
+    return frames;
+}
+
+void StemWavReaderClose(StemWavReader *reader) {
+    if (reader->file) fclose(reader->file);
+    free(reader->scratch);
+    memset(reader, 0, sizeof(*reader));
+}
+
+int StemWavReadMono(const char *path, float **outSamples, size_t *outFrameCount, double *outSampleRate) {
+    StemWavReader reader;
+    if (StemWavReaderOpen(&reader, path) != 0) return -1;
+
+    size_t total = (size_t)reader.frameCount;
+    float *mono = malloc((total ? total : 1) * sizeof(float));
+    float *block = malloc(4096 * reader.channelCount * sizeof(float));
+    if (!mono || !block) {
+        free(mono);
+        free(block);
+        StemWavReaderClose(&reader);
+        return -1;
+    }
+
+    size_t written = 0;
+    float scale = 1.0f / reader.channelCount;
+    size_t frames;
+    while ((frames = StemWavReaderRead(&reader, block, 4096)) > 0) {
+        for (size_t f = 0; f < frames; f++) {
+            float sum = 0.0f;
+            for (uint16_t c = 0; c < reader.channelCount; c++) {
+                sum += block[f * reader.channelCount + c];
+            }
+            mono[written++] = sum * scale;
+        }
+    }
+
+    *outSamples = mono;
+    *outFrameCount = written;
+    *outSampleRate = reader.sampleRate;
+
+    free(block);
+    StemWavReaderClose(&reader);
+    return 0;
+}
+
+static void PutLE16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void PutLE32(uint8_t *p, uint32_t v) {
+    PutLE16(p, (uint16_t)v);
+    PutLE16(p + 2, (uint16_t)(v >> 16));
+}
+
+static int WriteHeader(StemWavWriter *writer) {
+    uint16_t bytesPerSample = writer->floatFormat ? 4 : 2;
+    uint64_t dataSize = writer->framesWritten * writer->channelCount * bytesPerSample;
+    if (dataSize > 0xFFFFFFFFull - 36) dataSize = 0xFFFFFFFFull - 36;
+
+    uint8_t header[44];
+    memcpy(header, "RIFF", 4);
+    PutLE32(header + 4, (uint32_t)(36 + dataSize));
+    memcpy(header + 8, "WAVEfmt ", 8);
+    PutLE32(header + 16, 16);
+    PutLE16(header + 20, writer->floatFormat ? 3 : 1);
+    PutLE16(header + 22, writer->channelCount);
+    PutLE32(header + 24, writer->sampleRate);
+    PutLE32(header + 28, writer->sampleRate * writer->channelCount * bytesPerSample);
+    PutLE16(header + 32, (uint16_t)(writer->channelCount * bytesPerSample));
+    PutLE16(header + 34, (uint16_t)(bytesPerSample * 8));
+    memcpy(header + 36, "data", 4);
+    PutLE32(header + 40, (uint32_t)dataSize);
+
+    return fseek(writer->file, 0, SEEK_SET) == 0 && fwrite(header, 1, sizeof(header), writer->file) == sizeof(header) ? 0 : -1;
+}
+
+int StemWavWriterOpen(StemWavWriter *writer, const char *path, uint32_t sampleRate, uint16_t channelCount, int floatFormat) {
+    memset(writer, 0, sizeof(*writer));
+    if (channelCount == 0 || sampleRate == 0) return -1;
+
+    writer->file = fopen(path, "wb");
+    if (!writer->file) return -1;
+    writer->sampleRate = sampleRate;
+    writer->channelCount = channelCount;
+    writer->floatFormat = floatFormat;
+
+    // Placeholder header, rewritten with real sizes on close
+    if (WriteHeader(writer) != 0) {
+        fclose(writer->file);
+        memset(writer, 0, sizeof(*writer));
+        return -1;
+    }
+    return 0;
+}
+
+int StemWavWriterWrite(StemWavWriter *writer, const float *interleaved, size_t frameCount) {
+    size_t sampleCount = frameCount * writer->channelCount;
+    size_t byteCount = sampleCount * (writer->floatFormat ? 4 : 2);
+
+    if (writer->scratchSize < byteCount) {
+        uint8_t *scratch = realloc(writer->scratch, byteCount);
+        if (!scratch) return -1;
+        writer->scratch = scratch;
+        writer->scratchSize = byteCount;
+    }
+
+    uint8_t *dst = writer->scratch;
+    if (writer->floatFormat) {
+        for (size_t i = 0; i < sampleCount; i++) {
+            uint32_t bits;
+            memcpy(&bits, &interleaved[i], sizeof(bits));
+            PutLE32(dst + i * 4, bits);
+        }
+    } else {
+        for (size_t i = 0; i < sampleCount; i++) {
+            float value = interleaved[i] * 32767.0f;
+            value = value > 32767.0f ? 32767.0f : value < -32768.0f ? -32768.0f : value;
+            PutLE16(dst + i * 2, (uint16_t)(int16_t)lrintf(value));
+        }
+    }
+
+    if (fwrite(dst, 1, byteCount, writer->file) != byteCount) return -1;
+    writer->framesWritten += frameCount;
+    return 0;
+}
+
+int StemWavWriterClose(StemWavWriter *writer) {
+    if (!writer->file) return -1;
+    int status = WriteHeader(writer);
+    if (fclose(writer->file) != 0) status = -1;
+    free(writer->scratch);
+    memset(writer, 0, sizeof(*writer));
+    return status;
+}
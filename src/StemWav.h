@@ -0,0 +1,60 @@
+//
+//  StemWav.h
+//  Minimal streaming RIFF/WAVE reader and writer for stem files (portable C)
+//
+
+#ifndef STEM_WAV_H
+#define STEM_WAV_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Open stem file. Supports 16/24/32-bit integer PCM and 32-bit float.
+typedef struct {
+    FILE *file;
+    uint32_t sampleRate;
+    uint16_t channelCount;
+    uint16_t bitsPerSample;
+    uint16_t formatTag;       // 1 = PCM, 3 = IEEE float
+    uint64_t frameCount;      // Total frames in the data chunk
+    uint64_t framesRemaining;
+    uint8_t *scratch;         // Raw block buffer reused across reads
+    size_t scratchSize;
+} StemWavReader;
+
+// Returns 0 on success, -1 on failure (file missing or unsupported format).
+int StemWavReaderOpen(StemWavReader *reader, const char *path);
+// Reads up to maxFrames interleaved float frames. Returns frames read, 0 at end.
+size_t StemWavReaderRead(StemWavReader *reader, float *interleaved, size_t maxFrames);
+void StemWavReaderClose(StemWavReader *reader);
+
+// Convenience: decode the whole file into a freshly allocated mono buffer.
+// Caller frees *outSamples. Returns 0 on success.
+int StemWavReadMono(const char *path, float **outSamples, size_t *outFrameCount, double *outSampleRate);
+
+// Streaming writer. Sizes are patched into the header on close.
+typedef struct {
+    FILE *file;
+    uint32_t sampleRate;
+    uint16_t channelCount;
+    int floatFormat;          // 1 = 32-bit float, 0 = 16-bit PCM (clipped)
+    uint64_t framesWritten;
+    uint8_t *scratch;
+    size_t scratchSize;
+} StemWavWriter;
+
+int StemWavWriterOpen(StemWavWriter *writer, const char *path, uint32_t sampleRate, uint16_t channelCount, int floatFormat);
+int StemWavWriterWrite(StemWavWriter *writer, const float *interleaved, size_t frameCount);
+// Returns 0 if every write and the header patch succeeded.
+int StemWavWriterClose(StemWavWriter *writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -8,6 +8,10 @@
 #import <AVFoundation/AVFoundation.h>
 #import "TrackpadWrapper.h"
 #import "SystemCSSComponents.h"
+#import "StemAnalysis.h"
+#import "StemMixer.h"
+#import "StemFaderModel.h"
+#import "StemSeekDecoder.h"
 
 // Configuration
 #define MAX_POSSIBLE_FADERS 8  // Maximum possible faders
@@ -37,11 +41,16 @@ typedef struct {
 - (void)setValue:(CGFloat)value animated:(BOOL)animated;
 - (void)setActive:(BOOL)active;
 
+// Applies one published StemFaderModel entry, invalidating only the regions in dirtyFlags
+- (void)applyValue:(CGFloat)value active:(BOOL)active muted:(BOOL)muted dirty:(NSUInteger)dirtyFlags;
+
 @end
 
 @protocol SystemCSSFaderDelegate <NSObject>
 @optional
 - (void)fader:(SystemCSSFader *)fader valueChanged:(CGFloat)value;
+// Mouse press/release; the delegate owns the active state and publishes it back
+- (void)fader:(SystemCSSFader *)fader activeChanged:(BOOL)active;
 @end
 
 #pragma mark - Main Application Interface
@@ -71,9 +80,13 @@ typedef struct {
 @property (strong) AVAudioEngine *audioEngine;
 @property (strong) NSMutableArray<AVAudioPlayerNode *> *stemPlayers;
 @property (strong) NSMutableArray<AVAudioFile *> *stemFiles;
+@property (strong) NSMutableArray<StemSeekDecoder *> *stemDecoders;  // Random access for scrubbing
 @property (strong) NSMutableArray<NSString *> *stemNames;
 @property (nonatomic) BOOL isPlaying;
 
+// Analysis (tempo, beat grid, key) for the loaded song
+@property (strong) NSDictionary *songAnalysis;  // @"bpm", @"key", @"beats"
+
 // Trackpad
 @property (strong) TrackpadWrapper *trackpadWrapper;
 @property (strong) NSMutableDictionary *activeTouches;
@@ -99,6 +112,14 @@ typedef struct {
 - (void)playAudio;
 - (void)pauseAudio;
 - (void)stopAudio;
+- (NSTimeInterval)currentPlaybackTime;
+- (void)seekToTime:(NSTimeInterval)time;
+- (void)seekByInterval:(NSTimeInterval)interval;
+- (void)scrubToTime:(NSTimeInterval)time;
+- (void)scrubByInterval:(NSTimeInterval)interval;
+
+// Analysis
+- (void)analyzeStemsAtPaths:(NSArray<NSString *> *)stemPaths;
 
 // UI helpers
 - (NSButton *)createSystemButton:(NSString *)title action:(SEL)action frame:(NSRect)frame;
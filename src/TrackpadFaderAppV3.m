@@ -7,9 +7,12 @@
 #import <Carbon/Carbon.h>
 #import <CommonCrypto/CommonHMAC.h>
 #import <CommonCrypto/CommonDigest.h>
+#import <mach/mach_time.h>
 
 // MAX_FADERS is now replaced with dynamic _currentFaderCount
 
+static dispatch_queue_t StemAnalysisWorkQueue(void);
+
 #pragma mark - System.css Window
 
 @interface SystemFaderWindow : NSWindow
@@ -43,6 +46,15 @@
 }
 
 - (void)sendEvent:(NSEvent *)event {
+    // Horizontal two-finger swipe or tilt wheel scrubs through the song in the fader view
+    if (event.type == NSEventTypeScrollWheel && self.faderApp.faderContainer.superview &&
+        fabs(event.scrollingDeltaX) > fabs(event.scrollingDeltaY)) {
+        // Trackpads report points, wheels report lines
+        NSTimeInterval secondsPerUnit = event.hasPreciseScrollingDeltas ? 0.01 : 0.25;
+        [self.faderApp scrubByInterval:event.scrollingDeltaX * secondsPerUnit];
+        return;
+    }
+    
     if (event.type == NSEventTypeKeyDown) {
         unichar key = [[event charactersIgnoringModifiers] characterAtIndex:0];
         
@@ -77,6 +89,12 @@
                 [self.faderApp resetAllFaders];
                 return;
             }
+            
+            // Left/Right arrows - seek 5 seconds
+            if (key == NSLeftArrowFunctionKey || key == NSRightArrowFunctionKey) {
+                [self.faderApp seekByInterval:(key == NSLeftArrowFunctionKey) ? -5.0 : 5.0];
+                return;
+            }
         }
     }
     
@@ -118,9 +136,19 @@
 
 #pragma mark - System.css Fader Control
 
+static const CGFloat FaderMargin = 10.0;
+static const CGFloat FaderLabelHeight = 20.0;
+static const CGFloat FaderKnobHeight = 14.0;
+
 @implementation SystemCSSFader {
     NSRect _knobRect;
     NSRect _trackRect;
+    NSRect _grooveRect;
+    NSImage *_chromeImage;      // Background, borders, track and ticks; rebuilt only on resize
+    NSString *_labelText;       // Rebuilt only when the shown percentage or mute state changes
+    long _labelPercent;
+    BOOL _labelMuted;
+    NSString *_shortcutText;
     NSTrackingArea *_trackingArea;
     BOOL _isDragging;
     CGFloat _lastMouseY;
@@ -136,7 +164,9 @@
         _value = 50.0;
         _isActive = NO;
         _isMuted = NO;
+        _shortcutText = [NSString stringWithFormat:@"[%ld]", (long)index + 1];
         
+        [self layoutFaderRects];
         [self setupTrackingArea];
     }
     return self;
@@ -161,6 +191,70 @@
     [self setupTrackingArea];
 }
 
+- (void)setFrameSize:(NSSize)newSize {
+    [super setFrameSize:newSize];
+    _chromeImage = nil;
+    [self layoutFaderRects];
+}
+
+- (void)setLabel:(NSString *)label {
+    _label = [label copy];
+    _labelText = nil;
+}
+
+#pragma mark - Fader Geometry
+
+- (void)layoutFaderRects {
+    NSRect bounds = self.bounds;
+    CGFloat knobWidth = bounds.size.width - (FaderMargin * 2);
+    _trackRect = NSMakeRect(FaderMargin, FaderLabelHeight + FaderMargin,
+                           knobWidth, bounds.size.height - FaderLabelHeight - (FaderMargin * 2));
+    _grooveRect = NSInsetRect(_trackRect, 2, 2);
+    _knobRect = [self knobRectForValue:_value];
+}
+
+- (CGFloat)ratioForValue:(CGFloat)value {
+    return (value - _minValue) / (_maxValue - _minValue);
+}
+
+- (NSRect)knobRectForValue:(CGFloat)value {
+    CGFloat knobY = _trackRect.origin.y + (_trackRect.size.height - FaderKnobHeight) * [self ratioForValue:value];
+    return NSMakeRect(_trackRect.origin.x, knobY, _trackRect.size.width, FaderKnobHeight);
+}
+
+// Knob plus its 2pt border and drop shadow
+- (NSRect)knobDirtyRectForValue:(CGFloat)value {
+    return NSInsetRect([self knobRectForValue:value], -3, -3);
+}
+
+- (NSRect)labelRect {
+    return NSMakeRect(0, 0, self.bounds.size.width, FaderLabelHeight);
+}
+
+- (NSRect)shortcutRect {
+    return NSMakeRect(0, self.bounds.size.height - 14, 30, 14);
+}
+
+// The fill top always sits inside the knob, so the span between the old and
+// new knobs covers every fill pixel that changed
+- (void)invalidateValueChangeFrom:(CGFloat)oldValue {
+    if (oldValue == _value) return;
+    _knobRect = [self knobRectForValue:_value];
+    [self setNeedsDisplayInRect:NSUnionRect([self knobDirtyRectForValue:oldValue],
+                                            [self knobDirtyRectForValue:_value])];
+    if (lrint(oldValue) != lrint(_value)) {
+        [self setNeedsDisplayInRect:[self labelRect]];
+    }
+}
+
+#pragma mark - Fader Value
+
+- (void)setValue:(CGFloat)value {
+    CGFloat oldValue = _value;
+    _value = value;
+    [self invalidateValueChangeFrom:oldValue];
+}
+
 - (void)setValue:(CGFloat)value animated:(BOOL)animated {
     CGFloat clampedValue = MIN(MAX(value, _minValue), _maxValue);
     
@@ -171,8 +265,7 @@
             [[self animator] setValue:clampedValue];
         }];
     } else {
-        _value = clampedValue;
-        [self setNeedsDisplay:YES];
+        self.value = clampedValue;
     }
     
     if ([_delegate respondsToSelector:@selector(fader:valueChanged:)]) {
@@ -185,56 +278,101 @@
     [self setNeedsDisplay:YES];
 }
 
+- (void)applyValue:(CGFloat)value active:(BOOL)active muted:(BOOL)muted dirty:(NSUInteger)dirtyFlags {
+    CGFloat oldValue = _value;
+    _value = MIN(MAX(value, _minValue), _maxValue);
+    _isActive = active;
+    _isMuted = muted;
+    
+    if (dirtyFlags & StemFaderDirtyStyle) {
+        // Colours of fill, knob, label and shortcut all change; only the chrome survives
+        _knobRect = [self knobRectForValue:_value];
+        [self setNeedsDisplay:YES];
+        return;
+    }
+    if (dirtyFlags & StemFaderDirtyKnob) {
+        [self invalidateValueChangeFrom:oldValue];
+    }
+    if (dirtyFlags & StemFaderDirtyLabel) {
+        [self setNeedsDisplayInRect:[self labelRect]];
+    }
+}
+
+#pragma mark - Fader Drawing
+
+- (NSImage *)chromeImage {
+    NSRect bounds = self.bounds;
+    NSRect trackRect = _trackRect;
+    NSRect grooveRect = _grooveRect;
+    
+    // Drawn lazily at the destination's backing scale and cached by NSImage
+    return [NSImage imageWithSize:bounds.size flipped:NO drawingHandler:^BOOL(NSRect dstRect) {
+        // System.css window frame style
+        [[NSColor colorWithCalibratedWhite:0.95 alpha:1.0] setFill];
+        NSRectFill(bounds);
+        
+        // Draw border
+        [[NSColor blackColor] setStroke];
+        NSBezierPath *borderPath = [NSBezierPath bezierPathWithRect:NSInsetRect(bounds, 0.5, 0.5)];
+        [borderPath setLineWidth:2.0];
+        [borderPath stroke];
+        
+        // Draw inner border (system.css double border effect)
+        [[NSColor whiteColor] setStroke];
+        NSBezierPath *innerBorder = [NSBezierPath bezierPathWithRect:NSInsetRect(bounds, 2.5, 2.5)];
+        [innerBorder setLineWidth:1.0];
+        [innerBorder stroke];
+        
+        // Draw track background (system.css style)
+        [[NSColor colorWithCalibratedWhite:0.85 alpha:1.0] setFill];
+        NSRectFill(trackRect);
+        
+        // Draw track inset border
+        [[NSColor colorWithCalibratedWhite:0.5 alpha:1.0] setStroke];
+        NSBezierPath *trackBorder = [NSBezierPath bezierPathWithRect:trackRect];
+        [trackBorder setLineWidth:1.0];
+        [trackBorder stroke];
+        
+        // Draw track groove
+        [[NSColor whiteColor] setFill];
+        NSRectFill(grooveRect);
+        
+        // Draw tick marks (left of the groove, so the value fill never covers them)
+        [[NSColor colorWithCalibratedWhite:0.3 alpha:1.0] setStroke];
+        NSBezierPath *ticks = [NSBezierPath bezierPath];
+        for (int i = 0; i <= 10; i++) {
+            CGFloat y = grooveRect.origin.y + (grooveRect.size.height * i / 10.0);
+            [ticks moveToPoint:NSMakePoint(grooveRect.origin.x - 3, y)];
+            [ticks lineToPoint:NSMakePoint(grooveRect.origin.x, y)];
+        }
+        [ticks setLineWidth:1.0];
+        [ticks stroke];
+        return YES;
+    }];
+}
+
 - (void)drawRect:(NSRect)dirtyRect {
     [super drawRect:dirtyRect];
     
     NSRect bounds = self.bounds;
-    CGFloat margin = 10.0;
-    CGFloat labelHeight = 20.0;
-    CGFloat knobHeight = 14.0;
-    CGFloat knobWidth = bounds.size.width - (margin * 2);
-    
-    // System.css window frame style
-    [[NSColor colorWithCalibratedWhite:0.95 alpha:1.0] setFill];
-    NSRectFill(bounds);
-    
-    // Draw border
-    [[NSColor blackColor] setStroke];
-    NSBezierPath *borderPath = [NSBezierPath bezierPathWithRect:NSInsetRect(bounds, 0.5, 0.5)];
-    [borderPath setLineWidth:2.0];
-    [borderPath stroke];
-    
-    // Draw inner border (system.css double border effect)
-    [[NSColor whiteColor] setStroke];
-    NSBezierPath *innerBorder = [NSBezierPath bezierPathWithRect:NSInsetRect(bounds, 2.5, 2.5)];
-    [innerBorder setLineWidth:1.0];
-    [innerBorder stroke];
-    
-    // Calculate track rect
-    _trackRect = NSMakeRect(margin, labelHeight + margin, 
-                           knobWidth, bounds.size.height - labelHeight - (margin * 2));
-    
-    // Draw track background (system.css style)
-    [[NSColor colorWithCalibratedWhite:0.85 alpha:1.0] setFill];
-    NSRectFill(_trackRect);
-    
-    // Draw track inset border
-    [[NSColor colorWithCalibratedWhite:0.5 alpha:1.0] setStroke];
-    NSBezierPath *trackBorder = [NSBezierPath bezierPathWithRect:_trackRect];
-    [trackBorder setLineWidth:1.0];
-    [trackBorder stroke];
-    
-    // Draw track groove
-    NSRect grooveRect = NSInsetRect(_trackRect, 2, 2);
-    [[NSColor whiteColor] setFill];
-    NSRectFill(grooveRect);
+    
+    // Static chrome: composite just the dirty part of the cached image
+    if (!_chromeImage) {
+        _chromeImage = [self chromeImage];
+    }
+    [_chromeImage drawInRect:dirtyRect
+                    fromRect:dirtyRect
+                   operation:NSCompositingOperationCopy
+                    fraction:1.0
+              respectFlipped:YES
+                       hints:nil];
     
     // Draw value fill (system.css progress bar style)
-    CGFloat valueRatio = (_value - _minValue) / (_maxValue - _minValue);
-    CGFloat fillHeight = grooveRect.size.height * valueRatio;
-    NSRect fillRect = NSMakeRect(grooveRect.origin.x, 
-                                grooveRect.origin.y,
-                                grooveRect.size.width, 
+    CGFloat valueRatio = [self ratioForValue:_value];
+    CGFloat fillHeight = _grooveRect.size.height * valueRatio;
+    NSRect fillRect = NSMakeRect(_grooveRect.origin.x, 
+                                _grooveRect.origin.y,
+                                _grooveRect.size.width, 
                                 fillHeight);
     
     NSColor *fillColor;
@@ -248,91 +386,89 @@
     [fillColor setFill];
     NSRectFill(fillRect);
     
-    // Draw tick marks
-    [[NSColor colorWithCalibratedWhite:0.3 alpha:1.0] setStroke];
-    for (int i = 0; i <= 10; i++) {
-        CGFloat y = grooveRect.origin.y + (grooveRect.size.height * i / 10.0);
-        NSBezierPath *tick = [NSBezierPath bezierPath];
-        [tick moveToPoint:NSMakePoint(grooveRect.origin.x - 3, y)];
-        [tick lineToPoint:NSMakePoint(grooveRect.origin.x, y)];
-        [tick setLineWidth:1.0];
-        [tick stroke];
-    }
-    
-    // Calculate knob position
-    CGFloat knobY = _trackRect.origin.y + (_trackRect.size.height - knobHeight) * valueRatio;
-    _knobRect = NSMakeRect(_trackRect.origin.x, knobY, knobWidth, knobHeight);
-    
     // Draw knob (system.css button style)
-    // Shadow
-    [[NSColor colorWithCalibratedWhite:0.0 alpha:0.3] setFill];
-    NSRect shadowRect = NSOffsetRect(_knobRect, 1, -1);
-    NSRectFill(shadowRect);
-    
-    // Knob background
-    NSColor *knobColor;
-    if (_isMuted) {
-        knobColor = [NSColor colorWithCalibratedWhite:0.6 alpha:1.0];  // Light gray for muted
-    } else if (_isActive) {
-        knobColor = [NSColor blackColor];  // Black for active
-    } else {
-        knobColor = [NSColor colorWithCalibratedWhite:0.9 alpha:1.0];  // White for normal
+    _knobRect = [self knobRectForValue:_value];
+    if ([self needsToDrawRect:[self knobDirtyRectForValue:_value]]) {
+        // Shadow
+        [[NSColor colorWithCalibratedWhite:0.0 alpha:0.3] setFill];
+        NSRect shadowRect = NSOffsetRect(_knobRect, 1, -1);
+        NSRectFill(shadowRect);
+        
+        // Knob background
+        NSColor *knobColor;
+        if (_isMuted) {
+            knobColor = [NSColor colorWithCalibratedWhite:0.6 alpha:1.0];  // Light gray for muted
+        } else if (_isActive) {
+            knobColor = [NSColor blackColor];  // Black for active
+        } else {
+            knobColor = [NSColor colorWithCalibratedWhite:0.9 alpha:1.0];  // White for normal
+        }
+        [knobColor setFill];
+        NSRectFill(_knobRect);
+        
+        // Knob border
+        [[NSColor blackColor] setStroke];
+        NSBezierPath *knobBorder = [NSBezierPath bezierPathWithRect:_knobRect];
+        [knobBorder setLineWidth:2.0];
+        [knobBorder stroke];
+        
+        // Knob highlight (system.css 3D effect)
+        [[NSColor whiteColor] setFill];
+        NSRect highlightRect = NSMakeRect(_knobRect.origin.x + 2, 
+                                         _knobRect.origin.y + 2,
+                                         _knobRect.size.width - 4, 2);
+        NSRectFill(highlightRect);
     }
-    [knobColor setFill];
-    NSRectFill(_knobRect);
-    
-    // Knob border
-    [[NSColor blackColor] setStroke];
-    NSBezierPath *knobBorder = [NSBezierPath bezierPathWithRect:_knobRect];
-    [knobBorder setLineWidth:2.0];
-    [knobBorder stroke];
-    
-    // Knob highlight (system.css 3D effect)
-    [[NSColor whiteColor] setFill];
-    NSRect highlightRect = NSMakeRect(_knobRect.origin.x + 2, 
-                                     _knobRect.origin.y + 2,
-                                     _knobRect.size.width - 4, 2);
-    NSRectFill(highlightRect);
     
     // Draw label
-    NSString *labelText;
-    NSDictionary *labelAttrs;
-    
-    if (_isMuted) {
-        labelText = [NSString stringWithFormat:@"%@ [MUTE]", _label];
-        labelAttrs = @{
-            NSFontAttributeName: [NSFont boldSystemFontOfSize:10],
-            NSForegroundColorAttributeName: [NSColor darkGrayColor]
-        };
-    } else {
-        labelText = [NSString stringWithFormat:@"%@ (%.0f%%)", _label, _value];
-        labelAttrs = @{
-            NSFontAttributeName: [NSFont systemFontOfSize:10],
-            NSForegroundColorAttributeName: [NSColor blackColor]
-        };
+    if ([self needsToDrawRect:[self labelRect]]) {
+        static NSDictionary *normalAttrs;
+        static NSDictionary *mutedAttrs;
+        static dispatch_once_t onceToken;
+        dispatch_once(&onceToken, ^{
+            normalAttrs = @{
+                NSFontAttributeName: [NSFont systemFontOfSize:10],
+                NSForegroundColorAttributeName: [NSColor blackColor]
+            };
+            mutedAttrs = @{
+                NSFontAttributeName: [NSFont boldSystemFontOfSize:10],
+                NSForegroundColorAttributeName: [NSColor darkGrayColor]
+            };
+        });
+        
+        long percent = lrint(_value);
+        if (!_labelText || percent != _labelPercent || _isMuted != _labelMuted) {
+            _labelText = _isMuted ? [NSString stringWithFormat:@"%@ [MUTE]", _label]
+                                  : [NSString stringWithFormat:@"%@ (%ld%%)", _label, percent];
+            _labelPercent = percent;
+            _labelMuted = _isMuted;
+        }
+        
+        NSDictionary *labelAttrs = _isMuted ? mutedAttrs : normalAttrs;
+        NSSize labelSize = [_labelText sizeWithAttributes:labelAttrs];
+        NSPoint labelPoint = NSMakePoint((bounds.size.width - labelSize.width) / 2, 2);
+        [_labelText drawAtPoint:labelPoint withAttributes:labelAttrs];
     }
     
-    NSSize labelSize = [labelText sizeWithAttributes:labelAttrs];
-    NSPoint labelPoint = NSMakePoint((bounds.size.width - labelSize.width) / 2, 2);
-    [labelText drawAtPoint:labelPoint withAttributes:labelAttrs];
-    
     // Draw keyboard shortcut hint
-    NSString *shortcutText = [NSString stringWithFormat:@"[%ld]", (long)_faderIndex + 1];
-    NSDictionary *shortcutAttrs = @{
-        NSFontAttributeName: [NSFont boldSystemFontOfSize:8],
-        NSForegroundColorAttributeName: _isActive ? [NSColor blackColor] : [NSColor grayColor]
-    };
-    [shortcutText drawAtPoint:NSMakePoint(2, bounds.size.height - 12) withAttributes:shortcutAttrs];
+    if ([self needsToDrawRect:[self shortcutRect]]) {
+        NSDictionary *shortcutAttrs = @{
+            NSFontAttributeName: [NSFont boldSystemFontOfSize:8],
+            NSForegroundColorAttributeName: _isActive ? [NSColor blackColor] : [NSColor grayColor]
+        };
+        [_shortcutText drawAtPoint:NSMakePoint(2, bounds.size.height - 12) withAttributes:shortcutAttrs];
+    }
 }
 
+#pragma mark - Fader Mouse
+
 - (void)mouseDown:(NSEvent *)event {
     NSPoint localPoint = [self convertPoint:event.locationInWindow fromView:nil];
     
     if (NSPointInRect(localPoint, _knobRect) || NSPointInRect(localPoint, _trackRect)) {
         _isDragging = YES;
         _lastMouseY = localPoint.y;
-        _isActive = YES;
-        [self setNeedsDisplay:YES];
+        [self mouseActiveChanged:YES];
     }
 }
 
@@ -350,7 +486,9 @@
 }
 
 - (void)mouseUp:(NSEvent *)event {
+    if (!_isDragging) return;
     _isDragging = NO;
+    [self mouseActiveChanged:NO];
 }
 
 - (void)mouseEntered:(NSEvent *)event {
@@ -359,9 +497,18 @@
 
 - (void)mouseExited:(NSEvent *)event {
     [NSCursor pop];
-    if (!_isDragging) {
-        _isActive = NO;
-        [self setNeedsDisplay:YES];
+    if (!_isDragging && _isActive) {
+        [self mouseActiveChanged:NO];
+    }
+}
+
+// The fader model publishes active state back through applyValue:, so a view
+// with a delegate never styles itself; standalone faders still do.
+- (void)mouseActiveChanged:(BOOL)active {
+    if ([_delegate respondsToSelector:@selector(fader:activeChanged:)]) {
+        [_delegate fader:self activeChanged:active];
+    } else {
+        [self setActive:active];
     }
 }
 
@@ -452,6 +599,26 @@ static CGEventRef MouseEventCallback(CGEventTapProxy proxy, CGEventType type, CG
     // Search
     NSSearchField *_searchField;
     NSMutableArray *_filteredSongs;
+    
+    // Analysis
+    NSString *_analysisCacheDir;  // Song cache dir the pending/loaded analysis belongs to
+    
+    // Transport
+    AVAudioFramePosition _playbackStartFrame;  // Song position the current schedule started from
+    AVAudioFramePosition _songLength;          // Shortest playable stem length
+    NSUInteger _scheduleGeneration;            // Invalidates completion handlers of replaced schedules
+    NSUInteger _loadGeneration;                // Invalidates background work for a replaced song
+    
+    // Scrubbing: events only move the target, one grain is played per display frame
+    BOOL _scrubbing;
+    BOOL _scrubPending;                        // Target moved since the last grain
+    BOOL _resumeAfterScrub;                    // Playback was running when the scrub began
+    CFTimeInterval _lastScrubEventTime;
+    NSUInteger _scrubGrains;
+    
+    // Display
+    StemFaderModel _faderModel;  // Touch-rate fader state, published to the views once per frame
+    NSTimer *_displayTimer;
 }
 
 - (void)applicationDidFinishLaunching:(NSNotification *)aNotification {
@@ -1291,10 +1458,55 @@ static CGEventRef MouseEventCallback(CGEventTapProxy proxy, CGEventType type, CG
     // Update trackpad zones for new fader count
     [self setupTrackpadZonesForCount:stemCount];
     
+    // Half a fader unit is under a pixel of knob travel on a 200pt fader
+    StemFaderModelInit(&_faderModel, stemCount, STEM_MIXER_DEFAULT_FADER, 0.5f);
+    [self startDisplayTimer];
+    
     // Update values display
     [self updateValuesDisplay];
 }
 
+#pragma mark - Display Frame
+
+- (void)startDisplayTimer {
+    [_displayTimer invalidate];
+    _displayTimer = [NSTimer timerWithTimeInterval:1.0 / 60.0
+                                            target:self
+                                          selector:@selector(displayFrame:)
+                                          userInfo:nil
+                                           repeats:YES];
+    // Common modes so faders keep drawing during window drags and menu tracking
+    [[NSRunLoop mainRunLoop] addTimer:_displayTimer forMode:NSRunLoopCommonModes];
+}
+
+- (void)stopDisplayTimer {
+    [_displayTimer invalidate];
+    _displayTimer = nil;
+}
+
+// Touches only write the model; this applies at most one change per fader per frame
+- (void)displayFrame:(NSTimer *)timer {
+    if (_scrubbing) {
+        [self scrubFrame];
+    }
+    
+    StemFaderFrame frame;
+    if (StemFaderModelPublish(&_faderModel, &frame) == 0) {
+        return;
+    }
+    
+    for (size_t i = 0; i < frame.count; i++) {
+        NSInteger index = frame.indices[i];
+        if (index >= (NSInteger)_faders.count) continue;
+        StemFaderState state = frame.states[i];
+        [_faders[index] applyValue:state.value active:state.active muted:state.muted dirty:frame.flags[i]];
+    }
+    
+    if (frame.statusDirty) {
+        [self updateValuesDisplay];
+    }
+}
+
 - (void)setupTrackpadZonesForCount:(NSInteger)faderCount {
     for (NSInteger i = 0; i < faderCount; i++) {
         _trackpadZones[i].startX = (CGFloat)i / faderCount;
@@ -1641,57 +1853,47 @@ static CGEventRef MouseEventCallback(CGEventTapProxy proxy, CGEventType type, CG
 - (void)toggleMuteFader:(NSInteger)index {
     if (index < 0 || index >= _currentFaderCount) return;
     
-    SystemCSSFader *fader = _faders[index];
+    float value = StemFaderModelValue(&_faderModel, index);
     
     if ([_mutedFaders containsObject:@(index)]) {
         [_mutedFaders removeObject:@(index)];
-        fader.isMuted = NO;
+        StemFaderModelSetMuted(&_faderModel, index, NO);
         
         // Unmute audio channel
         if (_audioEngine && index < _stemPlayers.count) {
             AVAudioPlayerNode *player = _stemPlayers[index];
-            float volume = fader.value / 100.0;
-            player.volume = volume;
+            player.volume = StemMixerGainForFader(value, NO);
         }
         
         NSLog(@"Unmuted %@", _stemNames[index]);
     } else {
         [_mutedFaders addObject:@(index)];
-        fader.isMuted = YES;
+        StemFaderModelSetMuted(&_faderModel, index, YES);
         
         // Mute audio channel
         if (_audioEngine && index < _stemPlayers.count) {
             AVAudioPlayerNode *player = _stemPlayers[index];
-            player.volume = 0.0;
+            player.volume = StemMixerGainForFader(value, YES);
         }
         
         NSLog(@"Muted %@", _stemNames[index]);
     }
-    
-    [fader setNeedsDisplay:YES];
-    [self updateValuesDisplay];
 }
 
 - (void)resetAllFaders {
-    for (SystemCSSFader *fader in _faders) {
-        [fader setValue:50.0 animated:YES];
-        fader.isActive = NO;
-        fader.isMuted = NO;
-        [fader setNeedsDisplay:YES];
-    }
     [_mutedFaders removeAllObjects];
-    [self updateValuesDisplay];
+    for (NSInteger i = 0; i < _faders.count; i++) {
+        StemFaderModelSetActive(&_faderModel, i, NO);
+        StemFaderModelSetMuted(&_faderModel, i, NO);
+        [_faders[i] setValue:STEM_MIXER_DEFAULT_FADER animated:YES];
+    }
     NSLog(@"All faders reset");
 }
 
 - (void)updateValuesDisplay {
-    NSMutableString *values = [NSMutableString string];
-    for (NSInteger i = 0; i < _faders.count; i++) {
-        SystemCSSFader *fader = _faders[i];
-        NSString *status = fader.isMuted ? @"MUTE" : [NSString stringWithFormat:@"%3.0f%%", fader.value];
-        [values appendFormat:@"F%ld: %@  ", (long)i + 1, status];
-    }
-    _valuesLabel.stringValue = values;
+    char values[256];
+    StemFaderModelFormatStatus(&_faderModel, values, sizeof(values));
+    _valuesLabel.stringValue = [NSString stringWithUTF8String:values];
 }
 
 #pragma mark - TrackpadWrapperDelegate
@@ -1728,7 +1930,7 @@ static CGEventRef MouseEventCallback(CGEventTapProxy proxy, CGEventType type, CG
         
         // Check if this fader is muted
         if ([_mutedFaders containsObject:@(zone)]) {
-            fader.isActive = YES;
+            StemFaderModelSetActive(&_faderModel, zone, YES);
             continue;
         }
         
@@ -1737,7 +1939,7 @@ static CGEventRef MouseEventCallback(CGEventTapProxy proxy, CGEventType type, CG
         if (isNewTouch) {
             // Store the initial Y position and current fader value
             _activeTouches[touchKey] = @(touch.normalizedPosition.y);
-            _faderBaseValues[touchKey] = @(fader.value);
+            _faderBaseValues[touchKey] = @(StemFaderModelValue(&_faderModel, zone));
         } else {
             // Calculate relative movement
             CGFloat initialY = [_activeTouches[touchKey] floatValue];
@@ -1752,10 +1954,12 @@ static CGEventRef MouseEventCallback(CGEventTapProxy proxy, CGEventType type, CG
             // Clamp to valid range
             newValue = fmax(fader.minValue, fmin(fader.maxValue, newValue));
             
-            [fader setValue:newValue animated:NO];
+            // Audio follows every touch; the views catch up on the next display frame
+            StemFaderModelSetValue(&_faderModel, zone, newValue);
+            [self applyGainForFaderAtIndex:zone value:newValue];
         }
         
-        fader.isActive = YES;
+        StemFaderModelSetActive(&_faderModel, zone, YES);
     }
     
     // Clean up ended touches
@@ -1772,12 +1976,10 @@ static CGEventRef MouseEventCallback(CGEventTapProxy proxy, CGEventType type, CG
     
     // Deactivate faders with no active touches
     if (touches.count == 0 || currentTouchIDs.count == 0) {
-        for (SystemCSSFader *fader in _faders) {
-            fader.isActive = NO;
+        for (NSInteger i = 0; i < _currentFaderCount; i++) {
+            StemFaderModelSetActive(&_faderModel, i, NO);
         }
     }
-    
-    [self updateValuesDisplay];
 }
 
 - (void)trackpadWrapper:(TrackpadWrapper *)wrapper hoverChanged:(NSArray<TrackpadTouch *> *)hovers {
@@ -1797,21 +1999,32 @@ static CGEventRef MouseEventCallback(CGEventTapProxy proxy, CGEventType type, CG
 }
 
 - (void)trackpadWrapper:(TrackpadWrapper *)wrapper scrollDetected:(TrackpadScrollEvent *)scrollEvent {
-    // Optional scroll handling
+    // Horizontal scroll scrubs through the song
+    if (!_isInFaderUI || _stemFiles.count == 0 || scrollEvent.deltaX == 0) {
+        return;
+    }
+    [self scrubByInterval:scrollEvent.deltaX * 0.05];
 }
 
 #pragma mark - SystemCSSFaderDelegate
 
 - (void)fader:(SystemCSSFader *)fader valueChanged:(CGFloat)value {
-    [self updateValuesDisplay];
-    
+    // Mouse drags and resets; the values label is refreshed by the display frame
+    StemFaderModelSetValue(&_faderModel, fader.faderIndex, value);
+    [self applyGainForFaderAtIndex:fader.faderIndex value:value];
+}
+
+- (void)fader:(SystemCSSFader *)fader activeChanged:(BOOL)active {
+    StemFaderModelSetActive(&_faderModel, fader.faderIndex, active);
+}
+
+- (void)applyGainForFaderAtIndex:(NSInteger)index value:(CGFloat)value {
     // Update audio volume if playing
-    if (_isPlaying && fader.faderIndex < _stemPlayers.count) {
-        AVAudioPlayerNode *player = _stemPlayers[fader.faderIndex];
-        if (player && !fader.isMuted) {
-            // Convert percentage to volume (0.0 to 1.0)
-            float volume = value / 100.0;
-            player.volume = volume;
+    if (_isPlaying && index < _stemPlayers.count) {
+        AVAudioPlayerNode *player = _stemPlayers[index];
+        if (player && ![_mutedFaders containsObject:@(index)]) {
+            // Same percentage-to-gain mapping stem-mixdown renders with
+            player.volume = StemMixerGainForFader(value, NO);
         }
     }
 }
@@ -1931,6 +2144,14 @@ static CGEventRef MouseEventCallback(CGEventTapProxy proxy, CGEventType type, CG
             }
         }
         
+        // Build seek tables off the main thread; the decoders then only load the sidecars
+        for (NSString *path in downloadedPaths) {
+            StemSeekTable table;
+            if (StemSeekTableLoadOrBuild(path.fileSystemRepresentation, &table) == 0) {
+                StemSeekTableFree(&table);
+            }
+        }
+        
         dispatch_async(dispatch_get_main_queue(), ^{
             // Remove progress indicator
             [progress removeFromSuperview];
@@ -2130,6 +2351,12 @@ static CGEventRef MouseEventCallback(CGEventTapProxy proxy, CGEventType type, CG
     
     _stemPlayers = [NSMutableArray array];
     _stemFiles = [NSMutableArray array];
+    _stemDecoders = [NSMutableArray array];
+    _playbackStartFrame = 0;
+    _songLength = 0;
+    _loadGeneration++;
+    _scrubbing = NO;
+    NSMutableArray<NSString *> *loadedPaths = [NSMutableArray array];
     
     for (NSInteger i = 0; i < stemPaths.count && i < _currentFaderCount; i++) {
         NSString *filePath = stemPaths[i];
@@ -2154,6 +2381,9 @@ static CGEventRef MouseEventCallback(CGEventTapProxy proxy, CGEventType type, CG
             [_audioEngine attachNode:player];
             [_audioEngine connect:player to:_audioEngine.mainMixerNode format:audioFile.processingFormat];
             
+            [loadedPaths addObject:filePath];
+            _songLength = (_songLength == 0) ? audioFile.length : MIN(_songLength, audioFile.length);
+            
             NSLog(@"Successfully loaded stem %ld: %@", (long)i, [[filePath lastPathComponent] stringByDeletingPathExtension]);
             
             // Update fader label based on actual stem
@@ -2172,6 +2402,8 @@ static CGEventRef MouseEventCallback(CGEventTapProxy proxy, CGEventType type, CG
     
     NSLog(@"Loaded %lu audio files successfully", (unsigned long)_stemFiles.count);
     
+    [self loadScrubDecodersForPaths:loadedPaths];
+    
     // Start audio engine
     NSError *error;
     if (![_audioEngine startAndReturnError:&error]) {
@@ -2180,6 +2412,39 @@ static CGEventRef MouseEventCallback(CGEventTapProxy proxy, CGEventType type, CG
     } else {
         NSLog(@"Audio engine started successfully with %lu files", (unsigned long)_stemFiles.count);
     }
+    
+    [self analyzeStemsAtPaths:stemPaths];
+}
+
+// Seek indexes for scrubbing are loaded on the analysis queue; each is only used
+// if it decodes the same samples at the same positions as AVAudioFile plays, and
+// scrubbing needs one for every stem.
+- (void)loadScrubDecodersForPaths:(NSArray<NSString *> *)paths {
+    NSUInteger generation = _loadGeneration;
+    dispatch_async(StemAnalysisWorkQueue(), ^{
+        NSMutableArray<StemSeekDecoder *> *decoders = [NSMutableArray array];
+        for (NSString *path in paths) {
+            StemSeekDecoder *decoder = [[StemSeekDecoder alloc] initWithPath:path];
+            // A private AVAudioFile, since the players read the shared ones
+            AVAudioFile *file = [[AVAudioFile alloc] initForReading:[NSURL fileURLWithPath:path] error:nil];
+            if (decoder && file && [decoder matchesAudioFile:file]) {
+                [decoders addObject:decoder];
+            } else if (decoder) {
+                NSLog(@"Seek table for %@ disagrees with AVAudioFile (%lld vs %lld frames), not used",
+                      path.lastPathComponent, (long long)decoder.length, (long long)file.length);
+            }
+        }
+        
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (generation != self->_loadGeneration) return;
+            if (decoders.count == paths.count) {
+                self->_stemDecoders = decoders;
+            } else {
+                NSLog(@"Seek tables usable for %lu of %lu stems, scrubbing disabled",
+                      (unsigned long)decoders.count, (unsigned long)paths.count);
+            }
+        });
+    });
 }
 
 - (void)playAudio {
@@ -2195,32 +2460,180 @@ static CGEventRef MouseEventCallback(CGEventTapProxy proxy, CGEventType type, CG
     }
     
     _isPlaying = YES;
+    _scrubbing = NO;
     _playButton.title = @"Pause";
     _stopButton.enabled = YES;
     
-    // Schedule and play all stem files
+    [self scheduleStemsFromFrame:_playbackStartFrame];
+    
+    _statusLabel.stringValue = @"Playing...";
+}
+
+- (void)scheduleStemsFromFrame:(AVAudioFramePosition)startFrame {
+    NSUInteger generation = ++_scheduleGeneration;
+    AVAudioFrameCount remaining = (AVAudioFrameCount)MAX(_songLength - startFrame, 0);
+    
+    // Schedule every stem from the same sample, with the next loop already queued
+    // behind it so the player timeline never has a gap
     for (NSInteger i = 0; i < _stemFiles.count && i < _stemPlayers.count; i++) {
         AVAudioPlayerNode *player = _stemPlayers[i];
         AVAudioFile *file = _stemFiles[i];
         
-        // Schedule the entire file
-        [player scheduleFile:file atTime:nil completionHandler:^{
-            // Loop the file when it finishes
-            dispatch_async(dispatch_get_main_queue(), ^{
-                if (self->_isPlaying) {
-                    [player scheduleFile:file atTime:nil completionHandler:nil];
-                    [player play];
-                }
-            });
-        }];
-        
-        [player play];
+        [player stop];
+        [player scheduleSegment:file startingFrame:startFrame frameCount:remaining atTime:nil completionHandler:nil];
+        [self scheduleLoopOnPlayer:player file:file generation:generation];
     }
     
-    _statusLabel.stringValue = @"Playing...";
+    [self startStemPlayersTogether];
+}
+
+// Queues one pass of exactly _songLength frames, so player time modulo
+// _songLength stays the song position however many times it loops
+- (void)scheduleLoopOnPlayer:(AVAudioPlayerNode *)player file:(AVAudioFile *)file generation:(NSUInteger)generation {
+    [player scheduleSegment:file startingFrame:0 frameCount:(AVAudioFrameCount)_songLength atTime:nil completionHandler:^{
+        // Keep one pass queued ahead, unless this schedule was replaced by a seek
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (self->_isPlaying && generation == self->_scheduleGeneration) {
+                [self scheduleLoopOnPlayer:player file:file generation:generation];
+            }
+        });
+    }];
+}
+
+// Starts all players on the same host time so the stems stay sample-aligned
+- (void)startStemPlayersTogether {
+    AVAudioTime *startTime = nil;
+    if (_audioEngine.isRunning) {
+        startTime = [AVAudioTime timeWithHostTime:mach_absolute_time() + [AVAudioTime hostTimeForSeconds:0.02]];
+    }
+    for (AVAudioPlayerNode *player in _stemPlayers) {
+        [player playAtTime:startTime];
+    }
+}
+
+- (double)songSampleRate {
+    return _stemFiles.count > 0 ? _stemFiles[0].processingFormat.sampleRate : 44100.0;
+}
+
+- (AVAudioFramePosition)currentPlaybackFrame {
+    if (!_isPlaying || _stemPlayers.count == 0 || _songLength <= 0) {
+        return _playbackStartFrame;
+    }
+    
+    AVAudioPlayerNode *player = _stemPlayers[0];
+    AVAudioTime *nodeTime = player.lastRenderTime;
+    AVAudioTime *playerTime = nodeTime ? [player playerTimeForNodeTime:nodeTime] : nil;
+    if (!playerTime) {
+        return _playbackStartFrame;
+    }
+    return (_playbackStartFrame + MAX(playerTime.sampleTime, 0)) % _songLength;
+}
+
+- (NSTimeInterval)currentPlaybackTime {
+    return [self currentPlaybackFrame] / [self songSampleRate];
+}
+
+- (void)seekToTime:(NSTimeInterval)time {
+    if (_stemFiles.count == 0 || _songLength <= 0) {
+        return;
+    }
+    
+    AVAudioFramePosition frame = (AVAudioFramePosition)llround(time * [self songSampleRate]);
+    _playbackStartFrame = MIN(MAX(frame, 0), _songLength - 1);
+    
+    if (_isPlaying) {
+        [self scheduleStemsFromFrame:_playbackStartFrame];
+    }
+    [self updateTransportStatus];
+}
+
+- (void)updateTransportStatus {
+    NSInteger seconds = (NSInteger)([self currentPlaybackTime]);
+    NSInteger total = (NSInteger)(_songLength / [self songSampleRate]);
+    _statusLabel.stringValue = [NSString stringWithFormat:@"%@ %ld:%02ld / %ld:%02ld",
+                                _isPlaying ? @"Playing" : (_scrubbing ? @"Scrubbing" : @"Paused at"),
+                                (long)seconds / 60, (long)seconds % 60, (long)total / 60, (long)total % 60];
+}
+
+- (void)seekByInterval:(NSTimeInterval)interval {
+    [self seekToTime:[self currentPlaybackTime] + interval];
+}
+
+- (void)scrubByInterval:(NSTimeInterval)interval {
+    [self scrubToTime:[self currentPlaybackTime] + interval];
+}
+
+// Scroll events only move the target. Playback is paused for the gesture and
+// resumed once from where it ends, so a stream of events never reschedules the
+// stem files; displayFrame: auditions one grain per frame at the latest target.
+- (void)scrubToTime:(NSTimeInterval)time {
+    if (_stemFiles.count == 0 || _songLength <= 0) {
+        return;
+    }
+    
+    if (!_scrubbing) {
+        _resumeAfterScrub = _isPlaying;
+        if (_isPlaying) {
+            [self pauseAudio];
+        }
+        _scrubbing = YES;
+        _scrubGrains = 0;
+    }
+    
+    AVAudioFramePosition frame = (AVAudioFramePosition)llround(time * [self songSampleRate]);
+    _playbackStartFrame = MIN(MAX(frame, 0), _songLength - 1);
+    _scrubPending = YES;
+    _lastScrubEventTime = CACurrentMediaTime();
+}
+
+- (void)scrubFrame {
+    // No events for a few frames ends the gesture
+    if (CACurrentMediaTime() - _lastScrubEventTime > 0.15) {
+        [self finishScrub];
+        return;
+    }
+    if (!_scrubPending) {
+        return;
+    }
+    _scrubPending = NO;
+    [self updateTransportStatus];
+    if (_stemDecoders.count != _stemPlayers.count) {
+        return;
+    }
+    
+    // A grain decoded straight from the seek tables, replacing the previous one
+    AVAudioFrameCount grain = (AVAudioFrameCount)([self songSampleRate] * 0.06);
+    BOOL started = _stemPlayers.count > 0 && _stemPlayers[0].isPlaying;
+    for (NSInteger i = 0; i < _stemPlayers.count; i++) {
+        AVAudioPCMBuffer *buffer = [_stemDecoders[i] readFrames:grain atPosition:_playbackStartFrame];
+        if (buffer) {
+            [_stemPlayers[i] scheduleBuffer:buffer atTime:nil options:AVAudioPlayerNodeBufferInterrupts completionHandler:nil];
+        }
+    }
+    _scrubGrains++;
+    if (!started) {
+        [self startStemPlayersTogether];
+    }
+}
+
+- (void)finishScrub {
+    _scrubbing = NO;
+    NSLog(@"Scrub ended at %.2fs, %lu grains decoded from seek tables",
+          [self currentPlaybackTime], (unsigned long)_scrubGrains);
+    
+    if (_resumeAfterScrub) {
+        [self playAudio];
+    } else {
+        _scheduleGeneration++;
+        for (AVAudioPlayerNode *player in _stemPlayers) {
+            [player stop];
+        }
+        [self updateTransportStatus];
+    }
 }
 
 - (void)pauseAudio {
+    _playbackStartFrame = [self currentPlaybackFrame];
     _isPlaying = NO;
     _playButton.title = @"Play";
     
@@ -2233,9 +2646,12 @@ static CGEventRef MouseEventCallback(CGEventTapProxy proxy, CGEventType type, CG
 
 - (void)stopAudio {
     _isPlaying = NO;
+    _scrubbing = NO;
     _playButton.title = @"Play";
     _playButton.enabled = YES;
     _stopButton.enabled = NO;
+    _playbackStartFrame = 0;
+    _scheduleGeneration++;
     
     for (AVAudioPlayerNode *player in _stemPlayers) {
         [player stop];
@@ -2249,6 +2665,217 @@ static CGEventRef MouseEventCallback(CGEventTapProxy proxy, CGEventType type, CG
     [self resetAllFaders];
 }
 
+#pragma mark - Stem Analysis
+
+// Songs are analysed in the background on at most one worker per core.
+// A serial admission queue waits for a free slot so GCD never parks more
+// than one thread on the semaphore.
+static dispatch_queue_t StemAnalysisWorkQueue(void) {
+    static dispatch_queue_t queue;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        queue = dispatch_queue_create("stem-player.analysis.work",
+                                      dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_CONCURRENT, QOS_CLASS_UTILITY, 0));
+    });
+    return queue;
+}
+
+static dispatch_queue_t StemAnalysisAdmissionQueue(void) {
+    static dispatch_queue_t queue;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        queue = dispatch_queue_create("stem-player.analysis.admission", DISPATCH_QUEUE_SERIAL);
+    });
+    return queue;
+}
+
+static dispatch_semaphore_t StemAnalysisSlots(void) {
+    static dispatch_semaphore_t slots;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        slots = dispatch_semaphore_create(MAX(1, [[NSProcessInfo processInfo] activeProcessorCount]));
+    });
+    return slots;
+}
+
+// Decodes a stem with AVAudioFile and mixes it down to mono. Caller frees the buffer.
+static float *StemDecodeMono(NSString *path, size_t *outFrameCount, double *outSampleRate) {
+    NSError *error;
+    AVAudioFile *file = [[AVAudioFile alloc] initForReading:[NSURL fileURLWithPath:path] error:&error];
+    if (!file || error) {
+        NSLog(@"Analysis: cannot open %@: %@", path, error);
+        return NULL;
+    }
+    
+    AVAudioFormat *format = file.processingFormat;
+    AVAudioFrameCount chunkFrames = 65536;
+    AVAudioPCMBuffer *buffer = [[AVAudioPCMBuffer alloc] initWithPCMFormat:format frameCapacity:chunkFrames];
+    
+    size_t capacity = (size_t)MAX(file.length, (AVAudioFramePosition)chunkFrames);
+    float *mono = malloc(capacity * sizeof(float));
+    size_t written = 0;
+    AVAudioChannelCount channels = format.channelCount;
+    float scale = 1.0f / channels;
+    
+    while (mono && [file readIntoBuffer:buffer frameCount:chunkFrames error:&error] && buffer.frameLength > 0) {
+        AVAudioFrameCount frames = buffer.frameLength;
+        if (written + frames > capacity) {
+            capacity = (written + frames) * 2;
+            float *grown = realloc(mono, capacity * sizeof(float));
+            if (!grown) {
+                free(mono);
+                mono = NULL;
+                break;
+            }
+            mono = grown;
+        }
+        
+        float *const *channelData = buffer.floatChannelData;
+        for (AVAudioFrameCount f = 0; f < frames; f++) {
+            float sum = 0.0f;
+            for (AVAudioChannelCount c = 0; c < channels; c++) {
+                sum += channelData[c][f];
+            }
+            mono[written + f] = sum * scale;
+        }
+        written += frames;
+    }
+    
+    *outFrameCount = written;
+    *outSampleRate = format.sampleRate;
+    return mono;
+}
+
+static NSDictionary *StemAnalysisDictionary(const StemAnalysisResult *result) {
+    NSMutableArray *beats = [NSMutableArray arrayWithCapacity:result->beatCount];
+    for (uint32_t i = 0; i < result->beatCount; i++) {
+        [beats addObject:@(result->beatTimes[i])];
+    }
+    return @{
+        @"bpm": @(result->bpm),
+        @"key": @(StemAnalysisKeyName(result->keyTonic, result->keyMode)),
+        @"beats": beats
+    };
+}
+
+static int StemAnalysisSourcesForStemPaths(NSArray<NSString *> *stemPaths, StemAnalysisSources *sources) {
+    const char *paths[STEM_ANALYSIS_MAX_STEMS];
+    if (stemPaths.count > STEM_ANALYSIS_MAX_STEMS) return -1;
+    for (NSUInteger i = 0; i < stemPaths.count; i++) {
+        paths[i] = stemPaths[i].fileSystemRepresentation;
+    }
+    return StemAnalysisSourcesForPaths(paths, stemPaths.count, sources);
+}
+
+- (void)analyzeStemsAtPaths:(NSArray<NSString *> *)stemPaths {
+    if (stemPaths.count == 0) return;
+    
+    NSString *cacheDir = [stemPaths[0] stringByDeletingLastPathComponent];
+    NSString *sidecarPath = [cacheDir stringByAppendingPathComponent:@STEM_ANALYSIS_SIDECAR_NAME];
+    _analysisCacheDir = cacheDir;
+    _songAnalysis = nil;
+    
+    // Each song is analysed once; later loads read the sidecar unless the stems changed
+    StemAnalysisSources sources;
+    BOOL cacheable = StemAnalysisSourcesForStemPaths(stemPaths, &sources) == 0;
+    StemAnalysisResult cached;
+    if (cacheable && StemAnalysisReadSidecar(sidecarPath.fileSystemRepresentation, &sources, &cached) == 0) {
+        [self applySongAnalysis:StemAnalysisDictionary(&cached) forCacheDir:cacheDir];
+        StemAnalysisResultFree(&cached);
+        return;
+    }
+    
+    static NSMutableSet *inFlight;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        inFlight = [NSMutableSet set];
+    });
+    @synchronized (inFlight) {
+        if ([inFlight containsObject:cacheDir]) return;
+        [inFlight addObject:cacheDir];
+    }
+    
+    NSArray *paths = [stemPaths copy];
+    dispatch_semaphore_t slots = StemAnalysisSlots();
+    dispatch_async(StemAnalysisAdmissionQueue(), ^{
+        dispatch_semaphore_wait(slots, DISPATCH_TIME_FOREVER);
+        dispatch_async(StemAnalysisWorkQueue(), ^{
+            NSDate *start = [NSDate date];
+            NSUInteger stemCount = paths.count;
+            StemAnalysisInput *inputs = calloc(stemCount, sizeof(StemAnalysisInput));
+            float **buffers = calloc(stemCount, sizeof(float *));
+            double sampleRate = 0.0;
+            NSUInteger loaded = 0;
+            
+            for (NSString *path in paths) {
+                size_t frames = 0;
+                double rate = 0.0;
+                float *samples = StemDecodeMono(path, &frames, &rate);
+                if (!samples) continue;
+                if (loaded > 0 && rate != sampleRate) {
+                    free(samples);
+                    continue;
+                }
+                sampleRate = rate;
+                buffers[loaded] = samples;
+                inputs[loaded].samples = samples;
+                inputs[loaded].frameCount = frames;
+                inputs[loaded].role = StemRoleForName(path.lastPathComponent.UTF8String);
+                loaded++;
+            }
+            
+            StemAnalysisResult result;
+            NSDictionary *analysis = nil;
+            if (loaded > 0 && StemAnalysisRun(inputs, loaded, sampleRate, &result) == 0) {
+                // A partial result is shown but not cached, so the next load retries
+                if (!cacheable || loaded < stemCount) {
+                    NSLog(@"Analysis: %lu of %lu stems decoded, not caching", (unsigned long)loaded,
+                          (unsigned long)stemCount);
+                } else if (StemAnalysisWriteSidecar(sidecarPath.fileSystemRepresentation, &result, &sources) != 0) {
+                    NSLog(@"Analysis: failed to write %@", sidecarPath);
+                }
+                analysis = StemAnalysisDictionary(&result);
+                StemAnalysisResultFree(&result);
+            }
+            
+            for (NSUInteger i = 0; i < loaded; i++) {
+                free(buffers[i]);
+            }
+            free(buffers);
+            free(inputs);
+            
+            @synchronized (inFlight) {
+                [inFlight removeObject:cacheDir];
+            }
+            dispatch_semaphore_signal(slots);
+            
+            NSLog(@"Analysis of %@ took %.2fs", cacheDir.lastPathComponent, -[start timeIntervalSinceNow]);
+            if (analysis) {
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    [self applySongAnalysis:analysis forCacheDir:cacheDir];
+                });
+            }
+        });
+    });
+}
+
+- (void)applySongAnalysis:(NSDictionary *)analysis forCacheDir:(NSString *)cacheDir {
+    // Ignore results for a song the user has already left
+    if (![cacheDir isEqualToString:_analysisCacheDir]) return;
+    
+    _songAnalysis = analysis;
+    NSLog(@"Analysis: %.1f BPM, %@, %lu beats", [analysis[@"bpm"] floatValue], analysis[@"key"],
+          (unsigned long)[analysis[@"beats"] count]);
+    
+    NSString *title = _nowPlayingLabel.stringValue;
+    NSRange suffix = [title rangeOfString:@"  ["];
+    if (suffix.location != NSNotFound) {
+        title = [title substringToIndex:suffix.location];
+    }
+    _nowPlayingLabel.stringValue = [NSString stringWithFormat:@"%@  [%.0f BPM, %@]",
+                                    title, [analysis[@"bpm"] floatValue], analysis[@"key"]];
+}
+
 #pragma mark - Navigation
 
 - (void)backToSongSelection {
@@ -2265,7 +2892,14 @@ static CGEventRef MouseEventCallback(CGEventTapProxy proxy, CGEventType type, CG
         }
         _stemPlayers = nil;
         _stemFiles = nil;
+        _stemDecoders = nil;
     }
+    _loadGeneration++;
+    _scrubbing = NO;
+    
+    _songAnalysis = nil;
+    _analysisCacheDir = nil;
+    [self stopDisplayTimer];
     
     // Unlock cursor if it's locked
     if (_cursorLocked) {
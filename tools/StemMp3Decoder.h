@@ -0,0 +1,1035 @@
+//
+//  StemMp3Decoder.h
+//  Single-header MPEG-1/2/2.5 Layer III decoder for the batch tools (portable C)
+//
+//  Decodes one frame at a time with no global state. The only state carried
+//  from frame to frame is the bit reservoir, the IMDCT overlap and the
+//  synthesis filterbank history, so a decoder reset and fed from a seek
+//  table's decode frame reproduces a linear decode bit for bit from the
+//  target frame on. A frame whose reservoir bytes were never fed decodes as
+//  silence but still advances that state.
+//
+//  Define STEM_MP3_DECODER_IMPLEMENTATION in exactly one .c file before
+//  including this header.
+//
+
+#ifndef STEM_MP3_DECODER_H
+#define STEM_MP3_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STEM_MP3_MAX_SAMPLES_PER_FRAME 1152
+#define STEM_MP3_MAX_CHANNELS 2
+
+// Largest main_data_begin (MPEG-1) plus the largest frame, with room for the
+// bit reader to run off the end of corrupt data
+#define STEM_MP3_RESERVOIR_CAPACITY (511 + 1441 + 64)
+
+typedef struct {
+    uint32_t sampleRate;
+    uint16_t channelCount;
+    uint16_t samplesPerFrame;   // 1152 (MPEG-1) or 576 (MPEG-2/2.5)
+    int reservoirMissing;       // Decoded as silence: main data starts before the first fed frame
+} StemMp3FrameInfo;
+
+typedef struct {
+    // Stream state, cleared by Reset
+    uint8_t reservoir[STEM_MP3_RESERVOIR_CAPACITY];
+    size_t reservoirSize;
+    float overlap[STEM_MP3_MAX_CHANNELS][576];
+    float synthesis[STEM_MP3_MAX_CHANNELS][1024];
+    unsigned synthesisOffset[STEM_MP3_MAX_CHANNELS];
+
+    // Tables, built once by Init
+    float imdctLong[36][18];
+    float imdctShort[12][6];
+    float windows[4][36];
+    float antialiasCs[8];
+    float antialiasCa[8];
+    float matrix[64][32];
+    float synthesisWindow[512];
+    float intensityRatio[7][2];
+} StemMp3Decoder;
+
+// Builds the tables and resets the stream state
+void StemMp3DecoderInit(StemMp3Decoder *decoder);
+
+// Forgets the reservoir and filterbank history, e.g. before decoding from a seek point
+void StemMp3DecoderReset(StemMp3Decoder *decoder);
+
+// Decodes the complete frame at `frame` into info->samplesPerFrame interleaved
+// frames of info->channelCount floats. Returns 0 on success, -1 if this is not
+// a decodable Layer III frame (pcm and decoder state are left untouched).
+int StemMp3DecodeFrame(StemMp3Decoder *decoder, const uint8_t *frame, size_t size, float *pcm,
+                       StemMp3FrameInfo *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#ifdef STEM_MP3_DECODER_IMPLEMENTATION
+
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+#ifndef M_SQRT1_2
+#define M_SQRT1_2 0.70710678118654752440
+#endif
+
+#pragma mark - Tables
+
+// Huffman code trees (ISO 11172-3 table B.7) as pairs of children: a child > 0
+// indexes the next pair, a child <= 0 is a leaf holding -(x << 4 | y), or
+// -(vwxy) for the count1 tables QuadA/QuadB. Tables 17-23 share tree 16 and
+// 25-31 share tree 24, differing only in linbits.
+static const int16_t kStemMp3Tree1[6] = {
+    2, 0, 4, -16, -17, -1,
+};
+static const int16_t kStemMp3Tree2[16] = {
+    2, 0, 4, 14, 6, -17, 8, 12, 10, -18, -34, -2, -33, -32, -1, -16,
+};
+static const int16_t kStemMp3Tree3[16] = {
+    2, 14, 4, -17, 6, -16, 8, 12, 10, -18, -34, -2, -33, -32, -1, 0,
+};
+static const int16_t kStemMp3Tree5[30] = {
+    2, 0, 4, 28, 6, -17, 8, 22, 10, 16, 12, -49, 14, -50, -51, -35,
+    18, 20, -19, -3, -48, -34, 24, 26, -18, -33, -2, -32, -1, -16,
+};
+static const int16_t kStemMp3Tree6[30] = {
+    2, 26, 4, 22, 6, 18, 8, 16, 10, 14, 12, -35, -51, -3, -50, -48,
+    -19, -49, 20, -18, -34, -2, 24, -1, -33, -32, -17, 28, -16, 0,
+};
+static const int16_t kStemMp3Tree7[70] = {
+    2, 0, 4, 68, 6, 62, 8, 46, 10, 38, 12, 28, 14, 24, 16, 22,
+    18, 20, -85, -69, -84, -83, -53, -68, 26, -21, -37, -82, 30, 34, -81, 32,
+    -5, -52, -80, 36, -67, -51, 40, 44, 42, -20, -36, -66, -65, -64, 48, 58,
+    50, 56, 52, 54, -4, -35, -50, -3, -19, -49, 60, -18, -48, -34, 64, -17,
+    -33, 66, -2, -32, -1, -16,
+};
+static const int16_t kStemMp3Tree8[70] = {
+    2, 66, 4, -17, 6, 64, 8, 52, 10, 40, 12, 30, 14, 26, 16, 22,
+    18, -83, 20, -69, -85, -84, 24, -37, -53, -68, 28, -21, -82, -5, 32, 36,
+    -81, 34, -52, -67, 38, -36, -80, -51, 42, 46, 44, -65, -66, -20, 48, 50,
+    -4, -64, -35, -50, 54, 62, 56, -34, 58, 60, -19, -49, -3, -48, -2, -32,
+    -18, -33, 68, 0, -1, -16,
+};
+static const int16_t kStemMp3Tree9[70] = {
+    2, 64, 4, 56, 6, 46, 8, 36, 10, 28, 12, 22, 14, 18, 16, -53,
+    -85, -69, -83, 20, -84, -5, 24, 26, -68, -37, -82, -21, 30, 32, -81, -52,
+    -67, 34, -80, -4, 38, 44, 40, 42, -36, -66, -51, -64, -20, -65, 48, 52,
+    50, -19, -35, -50, -49, 54, -3, -48, 58, 62, 60, -18, -34, -2, -33, -32,
+    66, 68, -17, -1, -16, 0,
+};
+static const int16_t kStemMp3Tree10[126] = {
+    2, 0, 4, 124, 6, 116, 8, 90, 10, 64, 12, 46, 14, 34, 16, 28,
+    18, 24, 20, 22, -119, -103, -118, -87, 26, -71, -117, -102, 30, 32, -116, -86,
+    -101, -55, 36, 44, 38, 40, -115, -70, 42, -99, -85, -84, -39, -114, 48, 58,
+    50, 54, 52, -112, -100, -7, -98, 56, -69, -53, 60, -23, -6, 62, -83, -68,
+    66, 82, 68, 72, -113, 70, -54, -38, 74, 78, 76, -21, -37, -82, -81, 80,
+    -52, -67, 84, 86, -22, -97, -96, 88, -5, -80, 92, 110, 94, 104, 96, 102,
+    98, 100, -36, -66, -51, -4, -20, -65, 106, 108, -64, -35, -50, -3, 112, 114,
+    -19, -49, -48, -34, 118, -17, 120, 122, -18, -33, -2, -32, -1, -16,
+};
+static const int16_t kStemMp3Tree11[126] = {
+    2, 122, 4, 116, 6, 94, 8, 66, 10, 52, 12, 38, 14, 30, 16, 22,
+    18, 20, -119, -103, -118, -117, 24, 26, -102, -71, -116, 28, -87, -85, 32, 36,
+    34, -55, -86, -101, -115, -70, 40, 48, 42, -39, 44, 46, -69, -84, -53, -83,
+    -114, 50, -100, -7, 54, 58, -113, 56, -23, -112, 60, 62, -54, -99, -96, 64,
+    -68, -37, 68, 80, 70, 76, 72, -98, 74, -21, -82, -5, 78, -22, -38, -6,
+    82, 86, -97, 84, -81, -52, 88, 92, -80, 90, -67, -51, -36, -66, 96, 110,
+    98, 108, 100, 106, 102, 104, -20, -65, -4, -64, -35, -50, -19, -49, 112, -33,
+    114, -34, -3, -48, 118, -17, -18, 120, -2, -32, 124, 0, -1, -16,
+};
+static const int16_t kStemMp3Tree12[126] = {
+    2, 116, 4, 102, 6, 78, 8, 52, 10, 36, 12, 28, 14, 22, 16, 20,
+    18, -118, -119, -103, -87, -117, 24, 26, -102, -71, -116, -101, 30, 32, -86, -55,
+    34, -39, -115, -85, 38, 44, 40, 42, -114, -70, -100, -23, 46, 50, -113, 48,
+    -7, -112, -54, -99, 54, 66, 56, 64, 58, 60, -69, -84, -68, 62, -6, -5,
+    -38, -98, 68, 72, -97, 70, -22, -96, 74, 76, -53, -83, -37, -82, 80, 96,
+    82, 88, 84, 86, -21, -81, -52, -67, 90, 94, 92, -36, -80, -4, -66, -20,
+    98, 100, -51, -65, -35, -50, 104, 114, 106, 112, 108, -19, 110, -48, -64, -3,
+    -49, -34, -18, -33, 118, 124, 120, -17, 122, 0, -2, -32, -1, -16,
+};
+static const int16_t kStemMp3Tree13[510] = {
+    2, 0, 4, 506, 6, 480, 8, 412, 10, 342, 12, 276, 14, 218, 16, 168,
+    18, 132, 20, 102, 22, 74, 24, 58, 26, 46, 28, 40, 30, 38, 32, -255,
+    34, -237, 36, -253, -254, -252, -239, -223, 42, 44, -238, -207, -222, -191, 48, 56,
+    50, 52, -251, -206, -220, 54, -175, -233, -236, -221, 60, 68, 62, 66, 64, -190,
+    -250, -205, -235, -159, 70, 72, -249, -234, -189, -219, 76, 92, 78, 86, 80, 82,
+    -143, -248, -204, 84, -174, -158, 88, -247, -142, 90, -127, -126, 94, 98, -218, 96,
+    -173, -188, 100, -111, -203, -246, 104, 118, 106, 112, 108, 110, -232, -95, -157, -217,
+    114, 116, -245, -231, -172, -187, 120, 128, 122, 124, -79, -244, 126, -243, -202, -230,
+    -63, 130, -141, -216, 134, 154, 136, 144, 138, 140, -47, -242, 142, -15, -110, -156,
+    146, 150, 148, -171, -201, -94, 152, -78, -125, -215, 156, 166, 158, 162, 160, -62,
+    -200, -214, -185, 164, -155, -170, -31, -241, 170, 192, 172, 184, 174, 178, -240, 176,
+    -186, -229, 180, 182, -228, -140, -109, -227, 186, 190, -226, 188, -46, -14, -30, -225,
+    194, 208, 196, 202, 198, 200, -224, -93, -213, -124, 204, 206, -199, -77, -139, -184,
+    210, 216, 212, 214, -212, -154, -169, -108, -198, -61, 220, 256, 222, 242, 224, 232,
+    226, 230, 228, -45, -211, -123, -210, -29, 234, 238, -183, 236, -92, -197, 240, -195,
+    -153, -122, 244, 250, 246, -209, 248, -75, -167, -151, 252, 254, -13, -208, -138, -168,
+    258, 268, 260, 266, 262, 264, -76, -196, -107, -182, -60, -44, 270, 272, -194, -91,
+    274, -28, -181, -137, 278, 320, 280, 302, 282, 292, 284, 288, -193, 286, -152, -12,
+    -192, 290, -180, -106, 294, 298, 296, -59, -166, -121, -179, 300, -136, -90, 304, 314,
+    306, 310, -43, 308, -165, -105, -164, 312, -120, -135, 316, -178, -148, 318, -119, -118,
+    322, 332, 324, 326, -27, -177, 328, 330, -11, -176, -150, -74, 334, 340, 336, 338,
+    -58, -163, -89, -149, -42, -162, 344, 390, 346, 368, 348, 356, 350, 352, -26, -161,
+    354, -160, -10, -104, 358, 362, 360, -147, -134, -73, 364, 366, -57, -88, -133, -103,
+    370, 378, 372, 374, -41, -146, 376, -56, -87, -117, 380, 384, -131, 382, -102, -71,
+    386, 388, -116, -86, -101, -115, 392, 402, 394, 396, -25, -145, 398, 400, -9, -144,
+    -72, -132, 404, 410, 406, -40, -114, 408, -70, -100, -130, -24, 414, 454, 416, 442,
+    418, 428, 420, 424, 422, -23, -55, -39, -113, 426, -85, -7, 430, 436, 432, 434,
+    -112, -54, -99, -69, 438, 440, -84, -38, -98, -53, 444, 448, -129, 446, -8, -128,
+    450, 452, -22, -97, -6, -96, 456, 468, 458, 466, 460, 464, 462, -37, -83, -68,
+    -82, -5, -21, -81, 470, 476, 472, 474, -52, -67, -80, -36, 478, -20, -66, -51,
+    482, 500, 484, 494, 486, 490, -65, 488, -4, -64, 492, -19, -35, -50, 496, 498,
+    -49, -3, -48, -34, 502, 504, -18, -33, -2, -32, 508, -16, -17, -1,
+};
+static const int16_t kStemMp3Tree15[510] = {
+    2, 496, 4, 448, 6, 360, 8, 270, 10, 192, 12, 126, 14, 90, 16, 58,
+    18, 44, 20, 32, 22, 28, 24, 26, -255, -239, -254, -223, -238, 30, -253, -207,
+    34, 40, 36, 38, -252, -222, -237, -191, -251, 42, -206, -236, 46, 52, 48, 50,
+    -221, -175, -250, -190, 54, 56, -235, -205, -220, -159, 60, 74, 62, 68, 64, 66,
+    -249, -234, -189, -219, 70, 72, -143, -248, -204, -158, 76, 82, 78, 80, -233, -127,
+    -247, -173, 84, 86, -218, -188, -111, 88, -174, -15, 92, 110, 94, 104, 96, 98,
+    -203, -246, 100, 102, -142, -232, -95, -157, 106, 108, -245, -126, -231, -172, 112, 120,
+    114, 116, -202, -187, 118, -79, -217, -141, 122, 124, -244, -63, -243, -216, 128, 160,
+    130, 146, 132, 140, 134, 136, -230, -47, -242, 138, -110, -240, 142, 144, -31, -241,
+    -156, -201, 148, 154, 150, 152, -94, -171, -186, -229, 156, 158, -125, -215, -78, -228,
+    162, 176, 164, 170, 166, 168, -140, -200, -62, -109, 172, 174, -214, -227, -155, -185,
+    178, 184, 180, 182, -46, -170, -226, -30, 186, 190, -225, 188, -14, -224, -93, -213,
+    194, 238, 196, 220, 198, 210, 200, 206, 202, 204, -124, -199, -77, -139, -212, 208,
+    -184, -154, 212, 218, 214, 216, -169, -108, -198, -61, -211, -210, 222, 230, 224, 228,
+    226, -29, -45, -13, -123, -183, 232, 236, -209, 234, -92, -208, -197, -138, 240, 256,
+    242, 248, 244, 246, -168, -76, -196, -107, 250, 254, -182, 252, -153, -12, -60, -195,
+    258, 266, 260, 262, -122, -167, -166, 264, -192, -11, -194, 268, -44, -91, 272, 326,
+    274, 302, 276, 290, 278, 284, 280, 282, -181, -28, -137, -152, 286, 288, -193, -75,
+    -180, -106, 292, 296, 294, -179, -59, -121, 298, 300, -151, -136, -43, -90, 304, 314,
+    306, 310, -178, 308, -165, -27, -177, 312, -176, -105, 316, 322, 318, 320, -150, -74,
+    -164, -120, 324, -163, -135, -58, 328, 344, 330, 336, 332, 334, -89, -149, -42, -162,
+    338, 340, -26, -161, 342, -104, -10, -160, 346, 352, 348, 350, -134, -73, -148, -57,
+    354, 358, -147, 356, -119, -9, -88, -133, 362, 414, 364, 392, 366, 378, 368, 374,
+    370, 372, -41, -103, -118, -146, -145, 376, -25, -144, 380, 386, 382, 384, -72, -132,
+    -87, -117, 388, 390, -56, -131, -102, -71, 394, 400, 396, 398, -40, -130, -24, -129,
+    402, 408, 404, 406, -116, -8, -128, -86, 410, 412, -101, -55, -115, -70, 416, 432,
+    418, 424, 420, 422, -39, -114, -100, -23, 426, 428, -85, -113, 430, -54, -7, -112,
+    434, 440, 436, 438, -99, -69, -84, -38, 442, 444, -98, -22, 446, -53, -6, -96,
+    450, 482, 452, 470, 454, 462, 456, 460, -97, 458, -83, -68, -37, -82, 464, 466,
+    -21, -81, 468, -52, -5, -80, 472, 478, 474, 476, -67, -36, -66, -51, -65, 480,
+    -20, -4, 484, 492, 486, 488, -35, -50, 490, -19, -64, -3, 494, -34, -49, -48,
+    498, 506, 500, -17, 502, 504, -18, -33, -2, -32, 508, 0, -1, -16,
+};
+static const int16_t kStemMp3Tree16[510] = {
+    2, 0, 4, 506, 6, 466, 8, 330, 10, 112, 12, 48, 14, 40, 16, 30,
+    18, 24, 20, 22, -239, -254, -223, -253, 26, 28, -207, -252, -191, -251, 32, 36,
+    -175, 34, -250, -159, 38, -143, -249, -248, 42, -255, 44, 46, -127, -247, -111, -246,
+    50, 58, 52, 56, 54, -79, -95, -245, -244, -243, 60, -242, -240, 62, -63, 64,
+    66, 94, 68, 86, 70, 82, 72, 78, 74, -222, -206, 76, -236, -221, -233, 80,
+    -234, -217, -238, 84, -237, -235, 88, 90, -190, -205, 92, -174, -220, -219, 96, 106,
+    98, 102, -204, 100, -173, -218, 104, -202, -126, -172, 108, -189, 110, -94, -201, -125,
+    114, 206, 116, 120, 118, -31, -47, -15, -241, 122, 124, 172, 126, 150, 128, 140,
+    130, 134, -158, 132, -188, -203, 136, 138, -142, -232, -157, -231, 142, 148, 144, 146,
+    -187, -141, -216, -110, -230, -156, 152, 164, 154, 160, 156, 158, -171, -186, -229, -215,
+    -78, 162, -228, -140, 166, 168, -200, -62, -109, 170, -214, -155, 174, 192, 176, 186,
+    178, 182, 180, -225, -185, -170, -212, 184, -184, -169, 188, -227, -123, 190, -183, -208,
+    194, 200, 196, 198, -14, -224, -93, -213, 202, 204, -124, -199, -77, -139, 208, 282,
+    210, 254, 212, 238, 214, 226, 216, 222, 218, 220, -154, -108, -198, -61, 224, -13,
+    -92, -197, 228, 234, 230, 232, -138, -168, -153, -76, 236, -60, -182, -122, 240, 250,
+    242, 246, 244, -28, -91, -137, -192, 248, -152, -121, -226, 252, -46, -30, 256, 270,
+    258, 264, 260, 262, -211, -45, -210, -209, 266, -29, -59, 268, -151, -136, 272, 278,
+    274, 276, -196, -107, -195, -167, -44, 280, -194, -181, 284, 306, 286, 298, 288, 294,
+    290, 292, -193, -12, -75, -180, 296, -179, -106, -166, 300, 304, 302, -43, -90, -165,
+    -178, -27, 308, 320, 310, 314, -177, 312, -11, -176, 316, 318, -105, -150, -74, -164,
+    322, 326, 324, -163, -120, -135, 328, -42, -58, -89, 332, 428, 334, 390, 336, 368,
+    338, 356, 340, 350, 342, 346, 344, -161, -149, -104, 348, -148, -134, -119, 352, -162,
+    354, -103, -73, -87, 358, 362, -26, 360, -10, -160, 364, 366, -57, -147, -88, -133,
+    370, 378, 372, 374, -41, -146, 376, -25, -118, -9, 380, 384, -145, 382, -144, -72,
+    386, 388, -132, -117, -56, -131, 392, 412, 394, 404, 396, 400, 398, -130, -102, -40,
+    402, -24, -71, -116, 406, 408, -129, -128, 410, -55, -8, -86, 414, 422, 416, 420,
+    -115, 418, -101, -70, -39, -114, 424, -23, 426, -7, -100, -85, 430, 452, 432, 444,
+    434, 438, -113, 436, -112, -54, 440, 442, -99, -69, -84, -38, 446, 448, -98, -22,
+    -97, 450, -6, -96, 454, 462, 456, 460, -83, 458, -53, -68, -37, -82, -81, 464,
+    -21, -5, 468, 500, 470, 492, 472, 484, 474, 480, 476, 478, -52, -67, -80, -36,
+    482, -20, -66, -51, 486, 490, -65, 488, -4, -64, -35, -50, 494, 496, -19, -49,
+    498, -34, -3, -48, 502, 504, -18, -33, -2, -32, 508, -16, -17, -1,
+};
+static const int16_t kStemMp3Tree24[510] = {
+    2, 452, 4, 120, 6, 48, 8, 32, 10, 24, 12, 18, 14, 16, -239, -254,
+    -223, -253, 20, 22, -207, -252, -191, -251, 26, 30, -250, 28, -175, -159, -249, -248,
+    34, 42, 36, 40, 38, -247, -143, -127, -111, -246, 44, 46, -95, -245, -79, -244,
+    50, -255, 52, 58, 54, 56, -63, -243, -47, -242, 60, 64, -241, 62, -31, -240,
+    66, 90, 68, 76, -15, 70, 72, 74, -238, -222, -237, -206, 78, 84, 80, 82,
+    -236, -221, -190, -235, 86, 88, -205, -220, -174, -234, 92, 106, 94, 100, 96, 98,
+    -189, -219, -204, -158, 102, 104, -233, -173, -218, -188, 108, 114, 110, 112, -203, -142,
+    -232, -157, 116, 118, -217, -126, -231, -172, 122, 356, 124, 266, 126, 202, 128, 172,
+    130, 154, 132, 146, 134, 140, 136, 138, -202, -187, -141, -216, 142, -230, 144, -13,
+    -14, -224, 148, 152, 150, -201, -110, -156, -94, -186, 156, 164, 158, 162, -229, 160,
+    -171, -125, -215, -228, 166, 168, -140, -200, 170, -62, -78, -46, 174, 188, 176, 182,
+    178, 180, -109, -214, -227, -155, 184, 186, -185, -170, -226, -30, 190, 196, 192, 194,
+    -225, -93, -213, -124, 198, 200, -199, -77, -139, -184, 204, 234, 206, 220, 208, 214,
+    210, 212, -212, -154, -169, -108, 216, 218, -198, -61, -211, -45, 222, 228, 224, 226,
+    -210, -29, -123, -183, 230, 232, -209, -92, -197, -138, 236, 252, 238, 244, 240, 242,
+    -168, -153, -76, -196, 246, 248, -107, -182, 250, -60, -208, -12, 254, 260, 256, 258,
+    -195, -122, -167, -44, 262, 264, -194, -91, -181, -28, 268, 324, 270, 304, 272, 290,
+    274, 280, 276, 278, -137, -152, -193, -75, 282, 286, 284, -59, -192, -11, 288, -26,
+    -176, -10, 292, 296, -180, 294, -106, -166, 298, 300, -121, -151, 302, -144, -160, -9,
+    306, 314, 308, 310, -179, -136, 312, -178, -43, -90, 316, 322, 318, 320, -165, -27,
+    -177, -105, -150, -164, 326, 342, 328, 336, 330, 334, 332, -135, -74, -120, -58, -163,
+    338, 340, -89, -149, -42, -162, 344, 350, 346, 348, -161, -104, -134, -119, 352, 354,
+    -73, -148, -57, -147, 358, 420, 360, 390, 362, 376, 364, 370, 366, 368, -88, -133,
+    -41, -103, 372, 374, -118, -146, -25, -145, 378, 384, 380, 382, -72, -132, -87, -117,
+    386, 388, -56, -131, -102, -40, 392, 408, 394, 400, 396, 398, -130, -24, -71, -116,
+    402, 406, -129, 404, -8, -128, -86, -101, 410, 416, 412, -115, -23, 414, -7, -112,
+    418, -114, -55, -39, 422, 436, 424, 430, 426, 428, -70, -100, -85, -113, 432, 434,
+    -54, -99, -69, -84, 438, 444, 440, 442, -38, -98, -22, -97, 446, 450, 448, -53,
+    -6, -96, -83, -68, 454, 504, 456, 492, 458, 480, 460, 474, 462, 470, 464, 466,
+    -37, -82, -21, 468, -5, -80, -81, 472, -52, -67, 476, 478, -36, -66, -51, -20,
+    482, 490, 484, 488, -65, 486, -4, -64, -35, -50, -19, -49, 494, 500, 496, -18,
+    498, -34, -3, -48, -33, 502, -2, -32, 506, 508, -17, -1, -16, 0,
+};
+static const int16_t kStemMp3TreeQuadA[30] = {
+    2, 0, 4, 24, 6, 18, 8, 14, 10, 12, -11, -15, -13, -14, 16, -9,
+    -7, -5, 20, 22, -6, -3, -10, -12, 26, 28, -2, -1, -4, -8,
+};
+static const int16_t kStemMp3TreeQuadB[30] = {
+    2, 16, 4, 10, 6, 8, -15, -14, -13, -12, 12, 14, -11, -10, -9, -8,
+    18, 24, 20, 22, -7, -6, -5, -4, 26, 28, -3, -2, -1, 0,
+};
+
+// Synthesis window D[0..256] (ISO 11172-3 table B.3) in units of 2^-16
+static const int32_t kStemMp3SynthesisWindow[257] = {
+    0, -1, -1, -1, -1, -1, -1, -2, -2, -2, -2, -3,
+    -3, -4, -4, -5, -5, -6, -7, -7, -8, -9, -10, -11,
+    -13, -14, -16, -17, -19, -21, -24, -26, -29, -31, -35, -38,
+    -41, -45, -49, -53, -58, -63, -68, -73, -79, -85, -91, -97,
+    -104, -111, -117, -125, -132, -139, -147, -154, -161, -169, -176, -183,
+    -190, -196, -202, -208, 213, 218, 222, 225, 227, 228, 228, 227,
+    224, 221, 215, 208, 200, 189, 177, 163, 146, 127, 106, 83,
+    57, 29, -2, -36, -72, -111, -153, -197, -244, -294, -347, -401,
+    -459, -519, -581, -645, -711, -779, -848, -919, -991, -1064, -1137, -1210,
+    -1283, -1356, -1428, -1498, -1567, -1634, -1698, -1759, -1817, -1870, -1919, -1962,
+    -2001, -2032, -2057, -2075, -2085, -2087, -2080, -2063, 2037, 2000, 1952, 1893,
+    1822, 1739, 1644, 1535, 1414, 1280, 1131, 970, 794, 605, 402, 185,
+    -45, -288, -545, -814, -1095, -1388, -1692, -2006, -2330, -2663, -3004, -3351,
+    -3705, -4063, -4425, -4788, -5153, -5517, -5879, -6237, -6589, -6935, -7271, -7597,
+    -7910, -8209, -8491, -8755, -8998, -9219, -9416, -9585, -9727, -9838, -9916, -9959,
+    -9966, -9935, -9863, -9750, -9592, -9389, -9139, -8840, -8492, -8092, -7640, -7134,
+    6574, 5959, 5288, 4561, 3776, 2935, 2037, 1082, 70, -998, -2122, -3300,
+    -4533, -5818, -7154, -8540, -9975, -11455, -12980, -14548, -16155, -17799, -19478, -21189,
+    -22929, -24694, -26482, -28289, -30112, -31947, -33791, -35640, -37489, -39336, -41176, -43006,
+    -44821, -46617, -48390, -50137, -51853, -53534, -55178, -56778, -58333, -59838, -61289, -62684,
+    -64019, -65290, -66494, -67629, -68692, -69679, -70590, -71420, -72169, -72835, -73415, -73908,
+    -74313, -74630, -74856, -74992, 75038,
+};
+
+static const uint16_t kStemMp3BitratesMPEG1[16] = {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0};
+static const uint16_t kStemMp3BitratesMPEG2[16] = {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0};
+static const uint32_t kStemMp3SampleRates[9] = {44100, 48000, 32000, 22050, 24000, 16000, 11025, 12000, 8000};
+
+// Scalefactor band boundaries per sample rate, in the order above
+static const uint16_t kStemMp3LongBands[9][23] = {
+    {0, 4, 8, 12, 16, 20, 24, 30, 36, 44, 52, 62, 74, 90, 110, 134, 162, 196, 238, 288, 342, 418, 576},
+    {0, 4, 8, 12, 16, 20, 24, 30, 36, 42, 50, 60, 72, 88, 106, 128, 156, 190, 230, 276, 330, 384, 576},
+    {0, 4, 8, 12, 16, 20, 24, 30, 36, 44, 54, 66, 82, 102, 126, 156, 194, 240, 296, 364, 448, 550, 576},
+    {0, 6, 12, 18, 24, 30, 36, 44, 54, 66, 80, 96, 116, 140, 168, 200, 238, 284, 336, 396, 464, 522, 576},
+    {0, 6, 12, 18, 24, 30, 36, 44, 54, 66, 80, 96, 114, 136, 162, 194, 232, 278, 332, 394, 464, 540, 576},
+    {0, 6, 12, 18, 24, 30, 36, 44, 54, 66, 80, 96, 116, 140, 168, 200, 238, 284, 336, 396, 464, 522, 576},
+    {0, 6, 12, 18, 24, 30, 36, 44, 54, 66, 80, 96, 116, 140, 168, 200, 238, 284, 336, 396, 464, 522, 576},
+    {0, 6, 12, 18, 24, 30, 36, 44, 54, 66, 80, 96, 116, 140, 168, 200, 238, 284, 336, 396, 464, 522, 576},
+    {0, 12, 24, 36, 48, 60, 72, 88, 108, 132, 160, 192, 232, 280, 336, 400, 476, 566, 568, 570, 572, 574, 576},
+};
+
+static const uint16_t kStemMp3ShortBands[9][14] = {
+    {0, 4, 8, 12, 16, 22, 30, 40, 52, 66, 84, 106, 136, 192},
+    {0, 4, 8, 12, 16, 22, 28, 38, 50, 64, 80, 100, 126, 192},
+    {0, 4, 8, 12, 16, 22, 30, 42, 58, 78, 104, 138, 180, 192},
+    {0, 4, 8, 12, 18, 24, 32, 42, 56, 74, 100, 132, 174, 192},
+    {0, 4, 8, 12, 18, 26, 36, 48, 62, 80, 104, 136, 180, 192},
+    {0, 4, 8, 12, 18, 26, 36, 48, 62, 80, 104, 134, 174, 192},
+    {0, 4, 8, 12, 18, 26, 36, 48, 62, 80, 104, 134, 174, 192},
+    {0, 4, 8, 12, 18, 26, 36, 48, 62, 80, 104, 134, 174, 192},
+    {0, 8, 16, 24, 36, 52, 72, 96, 124, 160, 162, 164, 166, 192},
+};
+
+static const uint8_t kStemMp3Pretab[22] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 3, 3, 3, 2, 0};
+
+// MPEG-1 scalefac_compress -> slen1, slen2
+static const uint8_t kStemMp3Slen[2][16] = {
+    {0, 0, 0, 0, 3, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4},
+    {0, 1, 2, 3, 0, 1, 2, 3, 1, 2, 3, 1, 2, 3, 2, 3},
+};
+
+// MPEG-2 scalefactor counts per slen group: [partition][long, short, mixed][group]
+static const uint8_t kStemMp3LsfBands[6][3][4] = {
+    {{6, 5, 5, 5}, {9, 9, 9, 9}, {6, 9, 9, 9}},
+    {{6, 5, 7, 3}, {9, 9, 12, 6}, {6, 9, 12, 6}},
+    {{11, 10, 0, 0}, {18, 18, 0, 0}, {15, 18, 0, 0}},
+    {{7, 7, 7, 0}, {12, 12, 12, 0}, {6, 15, 12, 0}},
+    {{6, 6, 6, 3}, {12, 9, 9, 6}, {6, 12, 9, 6}},
+    {{8, 8, 5, 0}, {15, 12, 9, 0}, {6, 18, 9, 0}},
+};
+
+static const float kStemMp3AntialiasCoefficients[8] = {-0.6f, -0.535f, -0.33f, -0.185f, -0.095f, -0.041f, -0.0142f, -0.0037f};
+
+typedef struct {
+    const int16_t *tree;
+    uint8_t linbits;
+} StemMp3HuffmanTable;
+
+static const StemMp3HuffmanTable kStemMp3BigValueTables[32] = {
+    {NULL, 0}, {kStemMp3Tree1, 0}, {kStemMp3Tree2, 0}, {kStemMp3Tree3, 0},
+    {NULL, 0}, {kStemMp3Tree5, 0}, {kStemMp3Tree6, 0}, {kStemMp3Tree7, 0},
+    {kStemMp3Tree8, 0}, {kStemMp3Tree9, 0}, {kStemMp3Tree10, 0}, {kStemMp3Tree11, 0},
+    {kStemMp3Tree12, 0}, {kStemMp3Tree13, 0}, {NULL, 0}, {kStemMp3Tree15, 0},
+    {kStemMp3Tree16, 1}, {kStemMp3Tree16, 2}, {kStemMp3Tree16, 3}, {kStemMp3Tree16, 4},
+    {kStemMp3Tree16, 6}, {kStemMp3Tree16, 8}, {kStemMp3Tree16, 10}, {kStemMp3Tree16, 13},
+    {kStemMp3Tree24, 4}, {kStemMp3Tree24, 5}, {kStemMp3Tree24, 6}, {kStemMp3Tree24, 7},
+    {kStemMp3Tree24, 8}, {kStemMp3Tree24, 9}, {kStemMp3Tree24, 11}, {kStemMp3Tree24, 13},
+};
+
+#pragma mark - Bitstream
+
+typedef struct {
+    const uint8_t *data;
+    size_t position;   // Bits
+    size_t limit;      // Bits; reads past it return zeros
+} StemMp3Bits;
+
+static inline uint32_t StemMp3GetBit(StemMp3Bits *bits) {
+    size_t p = bits->position++;
+    if (p >= bits->limit) return 0;
+    return (bits->data[p >> 3] >> (7 - (p & 7))) & 1u;
+}
+
+static uint32_t StemMp3GetBits(StemMp3Bits *bits, int count) {
+    uint32_t value = 0;
+    while (count-- > 0) value = (value << 1) | StemMp3GetBit(bits);
+    return value;
+}
+
+// Trees are pairs of children; a child <= 0 is a leaf holding -symbol
+static int StemMp3DecodeSymbol(StemMp3Bits *bits, const int16_t *tree) {
+    int node = 0;
+    for (;;) {
+        int child = tree[node + (int)StemMp3GetBit(bits)];
+        if (child <= 0) return -child;
+        node = child;
+    }
+}
+
+typedef struct {
+    int mpeg1;
+    int rateIndex;            // Into kStemMp3SampleRates and the band tables
+    uint16_t channelCount;
+    uint16_t samplesPerFrame;
+    int mode;                 // 0 stereo, 1 joint stereo, 2 dual channel, 3 mono
+    int modeExtension;
+    uint32_t frameSize;
+    uint32_t sideInfoOffset;  // Header + optional CRC
+    uint32_t sideInfoSize;
+} StemMp3Header;
+
+static int StemMp3ParseHeader(const uint8_t *p, size_t available, StemMp3Header *header) {
+    if (available < 4 || p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) return -1;
+
+    int version = (p[1] >> 3) & 3;     // 0 = 2.5, 2 = 2, 3 = 1
+    int layer = (p[1] >> 1) & 3;       // 1 = Layer III
+    int bitrateIndex = p[2] >> 4;
+    int rateIndex = (p[2] >> 2) & 3;
+    if (version == 1 || layer != 1 || bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3) return -1;
+
+    header->mpeg1 = version == 3;
+    header->rateIndex = rateIndex + (version == 3 ? 0 : version == 2 ? 3 : 6);
+    header->mode = p[3] >> 6;
+    header->modeExtension = (p[3] >> 4) & 3;
+    header->channelCount = header->mode == 3 ? 1 : 2;
+    header->samplesPerFrame = header->mpeg1 ? 1152 : 576;
+
+    uint32_t sampleRate = kStemMp3SampleRates[header->rateIndex];
+    uint32_t bitrate = (header->mpeg1 ? kStemMp3BitratesMPEG1 : kStemMp3BitratesMPEG2)[bitrateIndex] * 1000u;
+    header->frameSize = (header->mpeg1 ? 144u : 72u) * bitrate / sampleRate + ((p[2] >> 1) & 1);
+    header->sideInfoOffset = (p[1] & 1) ? 4 : 6;
+    if (header->mpeg1) {
+        header->sideInfoSize = header->channelCount == 1 ? 17 : 32;
+    } else {
+        header->sideInfoSize = header->channelCount == 1 ? 9 : 17;
+    }
+    return header->frameSize > header->sideInfoOffset + header->sideInfoSize && header->frameSize <= available ? 0 : -1;
+}
+
+#pragma mark - Side Info
+
+typedef struct {
+    uint32_t part23Length;
+    uint32_t bigValues;
+    uint32_t globalGain;
+    uint32_t scalefacCompress;
+    uint32_t blockType;       // 0 normal, 1 start, 2 short, 3 stop
+    uint32_t mixed;
+    uint32_t tableSelect[3];
+    uint32_t subblockGain[3];
+    uint32_t region0Count;
+    uint32_t region1Count;
+    uint32_t preflag;
+    uint32_t scalefacScale;
+    uint32_t count1Table;
+} StemMp3Granule;
+
+typedef struct {
+    uint32_t mainDataBegin;
+    uint32_t scfsi[2][4];
+    StemMp3Granule granules[2][2];   // [granule][channel]
+} StemMp3SideInfo;
+
+static int StemMp3ParseSideInfo(const uint8_t *frame, const StemMp3Header *header, StemMp3SideInfo *side) {
+    StemMp3Bits bits = {frame + header->sideInfoOffset, 0, header->sideInfoSize * 8};
+    int channels = header->channelCount;
+    int granules = header->mpeg1 ? 2 : 1;
+
+    memset(side, 0, sizeof(*side));
+    if (header->mpeg1) {
+        side->mainDataBegin = StemMp3GetBits(&bits, 9);
+        StemMp3GetBits(&bits, channels == 1 ? 5 : 3);
+        for (int ch = 0; ch < channels; ch++) {
+            for (int band = 0; band < 4; band++) side->scfsi[ch][band] = StemMp3GetBit(&bits);
+        }
+    } else {
+        side->mainDataBegin = StemMp3GetBits(&bits, 8);
+        StemMp3GetBits(&bits, channels == 1 ? 1 : 2);
+    }
+
+    for (int gr = 0; gr < granules; gr++) {
+        for (int ch = 0; ch < channels; ch++) {
+            StemMp3Granule *g = &side->granules[gr][ch];
+            g->part23Length = StemMp3GetBits(&bits, 12);
+            g->bigValues = StemMp3GetBits(&bits, 9);
+            g->globalGain = StemMp3GetBits(&bits, 8);
+            g->scalefacCompress = StemMp3GetBits(&bits, header->mpeg1 ? 4 : 9);
+            if (g->bigValues > 288) return -1;
+
+            if (StemMp3GetBit(&bits)) {
+                g->blockType = StemMp3GetBits(&bits, 2);
+                g->mixed = StemMp3GetBit(&bits);
+                g->tableSelect[0] = StemMp3GetBits(&bits, 5);
+                g->tableSelect[1] = StemMp3GetBits(&bits, 5);
+                for (int w = 0; w < 3; w++) g->subblockGain[w] = StemMp3GetBits(&bits, 3);
+                if (g->blockType == 0) return -1;
+                g->region0Count = g->blockType == 2 && !g->mixed ? 8 : 7;
+                g->region1Count = 20 - g->region0Count;
+            } else {
+                for (int r = 0; r < 3; r++) g->tableSelect[r] = StemMp3GetBits(&bits, 5);
+                g->region0Count = StemMp3GetBits(&bits, 4);
+                g->region1Count = StemMp3GetBits(&bits, 3);
+            }
+            g->preflag = header->mpeg1 ? StemMp3GetBit(&bits) : 0;
+            g->scalefacScale = StemMp3GetBit(&bits);
+            g->count1Table = StemMp3GetBit(&bits);
+        }
+    }
+    return 0;
+}
+
+#pragma mark - Main Data
+
+typedef struct {
+    uint8_t longFactors[22];
+    uint8_t shortFactors[13][3];
+    uint8_t longIllegal[22];      // Intensity position meaning "no intensity stereo here"
+    uint8_t shortIllegal[13][3];
+} StemMp3Scalefactors;
+
+static void StemMp3ReadScalefactorsMPEG1(StemMp3Bits *bits, const StemMp3Granule *g, const uint32_t *scfsi,
+                                         int granule, StemMp3Scalefactors *sf) {
+    int slen1 = kStemMp3Slen[0][g->scalefacCompress];
+    int slen2 = kStemMp3Slen[1][g->scalefacCompress];
+
+    memset(sf->longIllegal, 7, sizeof(sf->longIllegal));
+    memset(sf->shortIllegal, 7, sizeof(sf->shortIllegal));
+    if (g->blockType == 2) {
+        int sfb = 0;
+        if (g->mixed) {
+            for (; sfb < 8; sfb++) sf->longFactors[sfb] = (uint8_t)StemMp3GetBits(bits, slen1);
+            sfb = 3;
+        }
+        for (; sfb < 12; sfb++) {
+            for (int w = 0; w < 3; w++) sf->shortFactors[sfb][w] = (uint8_t)StemMp3GetBits(bits, sfb < 6 ? slen1 : slen2);
+        }
+        memset(sf->shortFactors[12], 0, 3);
+        return;
+    }
+
+    // Groups of long bands can be shared with granule 0 (scfsi)
+    static const uint8_t groups[5] = {0, 6, 11, 16, 21};
+    for (int group = 0; group < 4; group++) {
+        if (granule == 1 && scfsi[group]) continue;
+        for (int sfb = groups[group]; sfb < groups[group + 1]; sfb++) {
+            sf->longFactors[sfb] = (uint8_t)StemMp3GetBits(bits, group < 2 ? slen1 : slen2);
+        }
+    }
+    sf->longFactors[21] = 0;
+}
+
+static void StemMp3ReadScalefactorsMPEG2(StemMp3Bits *bits, StemMp3Granule *g, int intensityRight,
+                                         StemMp3Scalefactors *sf) {
+    uint32_t sfc = g->scalefacCompress;
+    int slen[4] = {0, 0, 0, 0};
+    int partition;
+
+    if (!intensityRight) {
+        if (sfc < 400) {
+            slen[0] = (sfc >> 4) / 5; slen[1] = (sfc >> 4) % 5; slen[2] = (sfc & 15) >> 2; slen[3] = sfc & 3;
+            partition = 0;
+        } else if (sfc < 500) {
+            sfc -= 400;
+            slen[0] = (sfc >> 2) / 5; slen[1] = (sfc >> 2) % 5; slen[2] = sfc & 3;
+            partition = 1;
+        } else {
+            sfc -= 500;
+            slen[0] = sfc / 3; slen[1] = sfc % 3;
+            partition = 2;
+            g->preflag = 1;
+        }
+    } else {
+        sfc >>= 1;
+        if (sfc < 180) {
+            slen[0] = sfc / 36; slen[1] = (sfc % 36) / 6; slen[2] = (sfc % 36) % 6;
+            partition = 3;
+        } else if (sfc < 244) {
+            sfc -= 180;
+            slen[0] = (sfc & 63) >> 4; slen[1] = (sfc & 15) >> 2; slen[2] = sfc & 3;
+            partition = 4;
+        } else {
+            sfc -= 244;
+            slen[0] = sfc / 3; slen[1] = sfc % 3;
+            partition = 5;
+        }
+    }
+
+    int layout = g->blockType == 2 ? (g->mixed ? 2 : 1) : 0;
+    memset(sf, 0, sizeof(*sf));
+    int index = 0;
+    for (int group = 0; group < 4; group++) {
+        uint8_t illegal = (uint8_t)((1 << slen[group]) - 1);
+        for (int n = 0; n < kStemMp3LsfBands[partition][layout][group]; n++, index++) {
+            uint8_t value = (uint8_t)StemMp3GetBits(bits, slen[group]);
+            if (layout == 0 || (layout == 2 && index < 6)) {
+                sf->longFactors[index] = value;
+                sf->longIllegal[index] = illegal;
+            } else {
+                int shortIndex = layout == 2 ? index - 6 + 9 : index;
+                sf->shortFactors[shortIndex / 3][shortIndex % 3] = value;
+                sf->shortIllegal[shortIndex / 3][shortIndex % 3] = illegal;
+            }
+        }
+    }
+}
+
+// Huffman-decodes part 3 into quantised values. Returns the count of lines
+// that may be non-zero.
+static int StemMp3ReadSpectrum(StemMp3Bits *bits, const StemMp3Granule *g, const StemMp3Header *header,
+                               size_t endBit, int *values) {
+    const uint16_t *longBands = kStemMp3LongBands[header->rateIndex];
+    int bigEnd = (int)g->bigValues * 2;
+    int region1, region2;
+    if (g->blockType != 0) {
+        region1 = g->blockType == 2 ? 3 * kStemMp3ShortBands[header->rateIndex][3] : longBands[8];
+        region2 = 576;
+    } else {
+        uint32_t r1 = g->region0Count + 1;
+        uint32_t r2 = g->region0Count + g->region1Count + 2;
+        region1 = longBands[r1 < 22 ? r1 : 22];
+        region2 = longBands[r2 < 22 ? r2 : 22];
+    }
+    if (region1 > bigEnd) region1 = bigEnd;
+    if (region2 > bigEnd) region2 = bigEnd;
+
+    int i = 0;
+    for (; i < bigEnd; i += 2) {
+        const StemMp3HuffmanTable *table = &kStemMp3BigValueTables[g->tableSelect[i < region1 ? 0 : i < region2 ? 1 : 2]];
+        if (!table->tree) {
+            values[i] = values[i + 1] = 0;
+            continue;
+        }
+        int symbol = StemMp3DecodeSymbol(bits, table->tree);
+        int x = symbol >> 4, y = symbol & 15;
+        if (table->linbits && x == 15) x += (int)StemMp3GetBits(bits, table->linbits);
+        if (x && StemMp3GetBit(bits)) x = -x;
+        if (table->linbits && y == 15) y += (int)StemMp3GetBits(bits, table->linbits);
+        if (y && StemMp3GetBit(bits)) y = -y;
+        values[i] = x;
+        values[i + 1] = y;
+    }
+
+    // Count1 quadruples until part 3 runs out; a quad that overruns is dropped
+    const int16_t *quadTree = g->count1Table ? kStemMp3TreeQuadB : kStemMp3TreeQuadA;
+    while (i + 4 <= 576 && bits->position < endBit) {
+        int symbol = StemMp3DecodeSymbol(bits, quadTree);
+        int quad[4];
+        for (int q = 0; q < 4; q++) {
+            quad[q] = (symbol >> (3 - q)) & 1;
+            if (quad[q] && StemMp3GetBit(bits)) quad[q] = -1;
+        }
+        if (bits->position > endBit) break;
+        memcpy(values + i, quad, sizeof(quad));
+        i += 4;
+    }
+    int nonZero = i;
+    for (; i < 576; i++) values[i] = 0;
+    return nonZero;
+}
+
+static inline float StemMp3Power43(int value) {
+    double magnitude = value < 0 ? -value : value;
+    double scaled = magnitude * cbrt(magnitude);
+    return (float)(value < 0 ? -scaled : scaled);
+}
+
+// Dequantises into file order (short bands window by window)
+static void StemMp3Requantize(const StemMp3Granule *g, const StemMp3Scalefactors *sf, const StemMp3Header *header,
+                              const int *values, int nonZero, float *xr) {
+    const uint16_t *longBands = kStemMp3LongBands[header->rateIndex];
+    const uint16_t *shortBands = kStemMp3ShortBands[header->rateIndex];
+    double multiplier = 0.5 * (1.0 + g->scalefacScale);
+    double gain = 0.25 * ((double)g->globalGain - 210.0);
+
+    memset(xr, 0, 576 * sizeof(float));
+    int longEnd = g->blockType != 2 ? 22 : g->mixed ? (header->mpeg1 ? 8 : 6) : 0;
+    for (int sfb = 0; sfb < longEnd && longBands[sfb] < nonZero; sfb++) {
+        double exponent = gain - multiplier * (sf->longFactors[sfb] + (g->preflag ? kStemMp3Pretab[sfb] : 0));
+        float scale = (float)exp2(exponent);
+        for (int i = longBands[sfb]; i < longBands[sfb + 1]; i++) {
+            if (values[i]) xr[i] = StemMp3Power43(values[i]) * scale;
+        }
+    }
+    if (g->blockType != 2) return;
+
+    for (int sfb = g->mixed ? 3 : 0; sfb < 13; sfb++) {
+        int width = shortBands[sfb + 1] - shortBands[sfb];
+        int start = 3 * shortBands[sfb];
+        if (start >= nonZero) break;
+        for (int w = 0; w < 3; w++) {
+            double exponent = gain - 2.0 * g->subblockGain[w] - multiplier * sf->shortFactors[sfb][w];
+            float scale = (float)exp2(exponent);
+            for (int i = start + w * width; i < start + (w + 1) * width; i++) {
+                if (values[i]) xr[i] = StemMp3Power43(values[i]) * scale;
+            }
+        }
+    }
+}
+
+#pragma mark - Stereo
+
+static void StemMp3MidSide(float *left, float *right, int start, int end) {
+    const float scale = (float)M_SQRT1_2;
+    for (int i = start; i < end; i++) {
+        float mid = left[i], side = right[i];
+        left[i] = (mid + side) * scale;
+        right[i] = (mid - side) * scale;
+    }
+}
+
+static int StemMp3BandIsZero(const float *x, int start, int end) {
+    for (int i = start; i < end; i++) {
+        if (x[i] != 0.0f) return 0;
+    }
+    return 1;
+}
+
+static void StemMp3IntensityBand(const StemMp3Decoder *decoder, const StemMp3Header *header,
+                                 const StemMp3Granule *right, int position, float *l, float *r, int start, int end) {
+    float kl, kr;
+    if (header->mpeg1) {
+        kl = decoder->intensityRatio[position][0];
+        kr = decoder->intensityRatio[position][1];
+    } else {
+        // Odd positions attenuate the left channel, even ones the right
+        double base = (right->scalefacCompress & 1) ? M_SQRT1_2 : 0.840896415253714543;   // 2^-0.5, 2^-0.25
+        float k = (float)pow(base, (position + 1) >> 1);
+        kl = (position & 1) ? k : 1.0f;
+        kr = (position & 1) ? 1.0f : k;
+    }
+    for (int i = start; i < end; i++) {
+        float x = l[i];
+        l[i] = x * kl;
+        r[i] = x * kr;
+    }
+}
+
+// Works down from the top of the right channel's spectrum: bands above its last
+// non-zero line are intensity coded, the rest fall back to M/S if enabled.
+static void StemMp3IntensityStereo(const StemMp3Decoder *decoder, const StemMp3Header *header,
+                                   const StemMp3Granule *right, const StemMp3Scalefactors *sf, float *l, float *r) {
+    const uint16_t *longBands = kStemMp3LongBands[header->rateIndex];
+    const uint16_t *shortBands = kStemMp3ShortBands[header->rateIndex];
+    int midSide = header->modeExtension & 2;
+    int shortStart = right->blockType == 2 ? (right->mixed ? 3 : 0) : 13;
+    int longEnd = right->blockType == 2 ? (right->mixed ? (header->mpeg1 ? 8 : 6) : 0) : 22;
+
+    int nonZeroShort[3] = {0, 0, 0};
+    for (int sfb = 12; sfb >= shortStart; sfb--) {
+        int width = shortBands[sfb + 1] - shortBands[sfb];
+        int source = sfb == 12 ? 11 : sfb;   // The last band uses the one below
+        for (int w = 2; w >= 0; w--) {
+            int start = 3 * shortBands[sfb] + w * width;
+            if (!nonZeroShort[w] && !StemMp3BandIsZero(r, start, start + width)) nonZeroShort[w] = 1;
+            int position = sf->shortFactors[source][w];
+            if (!nonZeroShort[w] && position != sf->shortIllegal[source][w] && (!header->mpeg1 || position < 7)) {
+                StemMp3IntensityBand(decoder, header, right, position, l, r, start, start + width);
+            } else if (midSide) {
+                StemMp3MidSide(l, r, start, start + width);
+            }
+        }
+    }
+
+    int nonZero = nonZeroShort[0] | nonZeroShort[1] | nonZeroShort[2];
+    for (int sfb = longEnd - 1; sfb >= 0; sfb--) {
+        int start = longBands[sfb], end = longBands[sfb + 1];
+        int source = sfb == 21 ? 20 : sfb;
+        if (!nonZero && !StemMp3BandIsZero(r, start, end)) nonZero = 1;
+        int position = sf->longFactors[source];
+        if (!nonZero && position != sf->longIllegal[source] && (!header->mpeg1 || position < 7)) {
+            StemMp3IntensityBand(decoder, header, right, position, l, r, start, end);
+        } else if (midSide) {
+            StemMp3MidSide(l, r, start, end);
+        }
+    }
+}
+
+#pragma mark - Hybrid Filterbank
+
+static void StemMp3Reorder(const StemMp3Granule *g, const StemMp3Header *header, float *xr) {
+    const uint16_t *shortBands = kStemMp3ShortBands[header->rateIndex];
+    float scratch[576];
+    for (int sfb = g->mixed ? 3 : 0; sfb < 13; sfb++) {
+        int width = shortBands[sfb + 1] - shortBands[sfb];
+        int start = 3 * shortBands[sfb];
+        for (int f = 0; f < width; f++) {
+            for (int w = 0; w < 3; w++) scratch[3 * f + w] = xr[start + w * width + f];
+        }
+        memcpy(xr + start, scratch, 3 * width * sizeof(float));
+    }
+}
+
+static void StemMp3Antialias(const StemMp3Decoder *decoder, const StemMp3Granule *g, float *xr) {
+    int boundaries = g->blockType != 2 ? 31 : g->mixed ? 1 : 0;
+    for (int sb = 1; sb <= boundaries; sb++) {
+        for (int i = 0; i < 8; i++) {
+            float upper = xr[18 * sb - 1 - i], lower = xr[18 * sb + i];
+            xr[18 * sb - 1 - i] = upper * decoder->antialiasCs[i] - lower * decoder->antialiasCa[i];
+            xr[18 * sb + i] = lower * decoder->antialiasCs[i] + upper * decoder->antialiasCa[i];
+        }
+    }
+}
+
+// IMDCT, windowing and overlap-add per subband; leaves time-domain samples as
+// samples[slot * 32 + subband], frequency inversion applied
+static void StemMp3Hybrid(const StemMp3Decoder *decoder, const StemMp3Granule *g, const float *xr, float *overlap,
+                          float *samples) {
+    for (int sb = 0; sb < 32; sb++) {
+        const float *in = xr + 18 * sb;
+        float *previous = overlap + 18 * sb;
+        float out[36];
+        int blockType = g->blockType == 2 && g->mixed && sb < 2 ? 0 : (int)g->blockType;
+
+        if (StemMp3BandIsZero(in, 0, 18)) {
+            memset(out, 0, sizeof(out));
+        } else if (blockType != 2) {
+            for (int i = 0; i < 36; i++) {
+                float sum = 0.0f;
+                for (int k = 0; k < 18; k++) sum += in[k] * decoder->imdctLong[i][k];
+                out[i] = sum * decoder->windows[blockType][i];
+            }
+        } else {
+            memset(out, 0, sizeof(out));
+            for (int w = 0; w < 3; w++) {
+                for (int i = 0; i < 12; i++) {
+                    float sum = 0.0f;
+                    for (int k = 0; k < 6; k++) sum += in[3 * k + w] * decoder->imdctShort[i][k];
+                    out[6 + 6 * w + i] += sum * decoder->windows[2][i];
+                }
+            }
+        }
+
+        for (int i = 0; i < 18; i++) {
+            float sample = out[i] + previous[i];
+            previous[i] = out[18 + i];
+            if ((sb & 1) && (i & 1)) sample = -sample;
+            samples[i * 32 + sb] = sample;
+        }
+    }
+}
+
+// Polyphase synthesis of 18 slots of 32 subband samples into pcm[slot * 32 * stride]
+static void StemMp3Synthesize(StemMp3Decoder *decoder, int channel, const float *samples, float *pcm, int stride) {
+    float *v = decoder->synthesis[channel];
+    for (int slot = 0; slot < 18; slot++) {
+        const float *s = samples + slot * 32;
+        unsigned offset = decoder->synthesisOffset[channel] = (decoder->synthesisOffset[channel] - 64) & 1023;
+        for (int i = 0; i < 64; i++) {
+            float sum = 0.0f;
+            for (int k = 0; k < 32; k++) sum += decoder->matrix[i][k] * s[k];
+            v[(offset + i) & 1023] = sum;
+        }
+        for (int j = 0; j < 32; j++) {
+            float sum = 0.0f;
+            for (int i = 0; i < 8; i++) {
+                sum += decoder->synthesisWindow[64 * i + j] * v[(offset + 128 * i + j) & 1023];
+                sum += decoder->synthesisWindow[64 * i + 32 + j] * v[(offset + 128 * i + 96 + j) & 1023];
+            }
+            pcm[(slot * 32 + j) * stride] = sum;
+        }
+    }
+}
+
+#pragma mark - Public API
+
+void StemMp3DecoderInit(StemMp3Decoder *decoder) {
+    for (int i = 0; i < 36; i++) {
+        for (int k = 0; k < 18; k++) {
+            decoder->imdctLong[i][k] = (float)cos(M_PI / 72.0 * (2 * i + 19) * (2 * k + 1));
+        }
+    }
+    for (int i = 0; i < 12; i++) {
+        for (int k = 0; k < 6; k++) {
+            decoder->imdctShort[i][k] = (float)cos(M_PI / 24.0 * (2 * i + 7) * (2 * k + 1));
+        }
+    }
+
+    // Block type 0 (normal), 1 (start), 2 (short, first 12 used), 3 (stop)
+    for (int i = 0; i < 36; i++) {
+        float longWindow = (float)sin(M_PI / 36.0 * (i + 0.5));
+        decoder->windows[0][i] = longWindow;
+        decoder->windows[1][i] = i < 18 ? longWindow : i < 24 ? 1.0f
+                               : i < 30 ? (float)sin(M_PI / 12.0 * (i - 18 + 0.5)) : 0.0f;
+        decoder->windows[2][i] = i < 12 ? (float)sin(M_PI / 12.0 * (i + 0.5)) : 0.0f;
+        decoder->windows[3][i] = i < 6 ? 0.0f : i < 12 ? (float)sin(M_PI / 12.0 * (i - 6 + 0.5))
+                               : i < 18 ? 1.0f : longWindow;
+    }
+
+    for (int i = 0; i < 8; i++) {
+        double c = kStemMp3AntialiasCoefficients[i];
+        double norm = sqrt(1.0 + c * c);
+        decoder->antialiasCs[i] = (float)(1.0 / norm);
+        decoder->antialiasCa[i] = (float)(c / norm);
+    }
+
+    for (int i = 0; i < 64; i++) {
+        for (int k = 0; k < 32; k++) {
+            decoder->matrix[i][k] = (float)cos((16 + i) * (2 * k + 1) * M_PI / 64.0);
+        }
+    }
+
+    // The window is odd-symmetric about 256 except at multiples of 64
+    for (int i = 0; i <= 256; i++) {
+        float value = (float)(kStemMp3SynthesisWindow[i] / 65536.0);
+        decoder->synthesisWindow[i] = value;
+        if (i > 0) decoder->synthesisWindow[512 - i] = (i & 63) ? -value : value;
+    }
+
+    for (int p = 0; p < 7; p++) {
+        if (p == 6) {
+            decoder->intensityRatio[p][0] = 1.0f;
+            decoder->intensityRatio[p][1] = 0.0f;
+        } else {
+            double k = tan(p * M_PI / 12.0);
+            decoder->intensityRatio[p][0] = (float)(k / (1.0 + k));
+            decoder->intensityRatio[p][1] = (float)(1.0 / (1.0 + k));
+        }
+    }
+
+    StemMp3DecoderReset(decoder);
+}
+
+void StemMp3DecoderReset(StemMp3Decoder *decoder) {
+    decoder->reservoirSize = 0;
+    memset(decoder->overlap, 0, sizeof(decoder->overlap));
+    memset(decoder->synthesis, 0, sizeof(decoder->synthesis));
+    memset(decoder->synthesisOffset, 0, sizeof(decoder->synthesisOffset));
+}
+
+int StemMp3DecodeFrame(StemMp3Decoder *decoder, const uint8_t *frame, size_t size, float *pcm,
+                       StemMp3FrameInfo *info) {
+    StemMp3Header header;
+    StemMp3SideInfo side;
+    if (StemMp3ParseHeader(frame, size, &header) != 0 || StemMp3ParseSideInfo(frame, &header, &side) != 0) return -1;
+
+    int channels = header.channelCount;
+    int granules = header.mpeg1 ? 2 : 1;
+    info->sampleRate = kStemMp3SampleRates[header.rateIndex];
+    info->channelCount = header.channelCount;
+    info->samplesPerFrame = header.samplesPerFrame;
+
+    // Append this frame's main data behind what earlier frames left in the reservoir
+    size_t mainStart = header.sideInfoOffset + header.sideInfoSize;
+    size_t mainSize = header.frameSize - mainStart;
+    size_t available = decoder->reservoirSize;
+    memcpy(decoder->reservoir + available, frame + mainStart, mainSize);
+    decoder->reservoirSize += mainSize;
+    info->reservoirMissing = side.mainDataBegin > available;
+
+    StemMp3Bits bits = {decoder->reservoir, 0, decoder->reservoirSize * 8};
+    bits.position = info->reservoirMissing ? bits.limit : (available - side.mainDataBegin) * 8;
+
+    int jointStereo = channels == 2 && header.mode == 1;
+    StemMp3Scalefactors scalefactors[2];
+    memset(scalefactors, 0, sizeof(scalefactors));
+    for (int gr = 0; gr < granules; gr++) {
+        float xr[2][576];
+        int nonZero[2] = {0, 0};
+        for (int ch = 0; ch < channels; ch++) {
+            StemMp3Granule *g = &side.granules[gr][ch];
+            if (info->reservoirMissing) {
+                memset(xr[ch], 0, sizeof(xr[ch]));
+                continue;
+            }
+            size_t endBit = bits.position + g->part23Length;
+            int values[576];
+            if (header.mpeg1) {
+                StemMp3ReadScalefactorsMPEG1(&bits, g, side.scfsi[ch], gr, &scalefactors[ch]);
+            } else {
+                StemMp3ReadScalefactorsMPEG2(&bits, g, jointStereo && (header.modeExtension & 1) && ch == 1,
+                                             &scalefactors[ch]);
+            }
+            nonZero[ch] = StemMp3ReadSpectrum(&bits, g, &header, endBit, values);
+            StemMp3Requantize(g, &scalefactors[ch], &header, values, nonZero[ch], xr[ch]);
+            bits.position = endBit;
+        }
+
+        if (jointStereo && !info->reservoirMissing) {
+            if (header.modeExtension & 1) {
+                StemMp3IntensityStereo(decoder, &header, &side.granules[gr][1], &scalefactors[1], xr[0], xr[1]);
+            } else if (header.modeExtension & 2) {
+                StemMp3MidSide(xr[0], xr[1], 0, 576);
+            }
+        }
+
+        for (int ch = 0; ch < channels; ch++) {
+            // Without main data the granule is silent; its short/long choice doesn't matter
+            StemMp3Granule silent = {0};
+            const StemMp3Granule *g = info->reservoirMissing ? &silent : &side.granules[gr][ch];
+            float samples[576];
+            if (g->blockType == 2) StemMp3Reorder(g, &header, xr[ch]);
+            StemMp3Antialias(decoder, g, xr[ch]);
+            StemMp3Hybrid(decoder, g, xr[ch], decoder->overlap[ch], samples);
+            StemMp3Synthesize(decoder, ch, samples, pcm + gr * 576 * channels + ch, channels);
+        }
+    }
+
+    // Keep only what a later main_data_begin can reach back to
+    if (decoder->reservoirSize > 511) {
+        memmove(decoder->reservoir, decoder->reservoir + decoder->reservoirSize - 511, 511);
+        decoder->reservoirSize = 511;
+    }
+    return 0;
+}
+
+#endif
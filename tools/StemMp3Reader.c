@@ -0,0 +1,118 @@
+//
+//  StemMp3Reader.c
+//  Streaming, sample-accurate MP3 stem reader for the batch tools
+//
+
+#define STEM_MP3_DECODER_IMPLEMENTATION
+#include "StemMp3Reader.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Largest Layer III frame (320 kbps at 32 kHz, or 160 kbps at 8 kHz) plus padding
+#define MAX_FRAME_BYTES 1441
+
+int StemMp3ReaderOpen(StemMp3Reader *reader, const char *path) {
+    memset(reader, 0, sizeof(*reader));
+    if (StemSeekTableLoadOrBuild(path, &reader->table) != 0) return -1;
+
+    reader->file = fopen(path, "rb");
+    reader->decoder = malloc(sizeof(StemMp3Decoder));
+    reader->frameBytes = malloc(MAX_FRAME_BYTES);
+    reader->pcm = malloc(sizeof(float) * STEM_MP3_MAX_SAMPLES_PER_FRAME * STEM_MP3_MAX_CHANNELS);
+    if (!reader->file || !reader->decoder || !reader->frameBytes || !reader->pcm ||
+        reader->table.channelCount > STEM_MP3_MAX_CHANNELS) {
+        StemMp3ReaderClose(reader);
+        return -1;
+    }
+
+    StemMp3DecoderInit(reader->decoder);
+    reader->sampleRate = reader->table.sampleRate;
+    reader->channelCount = reader->table.channelCount;
+    reader->frameCount = reader->table.sampleCount;
+    if (reader->frameCount > 0 && StemMp3ReaderSeek(reader, 0) != 0) {
+        StemMp3ReaderClose(reader);
+        return -1;
+    }
+    return 0;
+}
+
+int StemMp3ReaderSeek(StemMp3Reader *reader, uint64_t sample) {
+    StemSeekPoint point;
+    if (StemSeekTableLocate(&reader->table, sample, &point) != 0) return -1;
+
+    StemMp3DecoderReset(reader->decoder);
+    reader->nextFrame = point.decodeFrame;
+    reader->discardRemaining = point.discardSamples;
+    reader->pcmOffset = reader->pcmCount = 0;
+    reader->position = sample;
+    return fseek(reader->file, (long)point.byteOffset, SEEK_SET) == 0 ? 0 : -1;
+}
+
+// Decodes the next frame into pcm. Returns -1 at the end of the audio.
+static int DecodeNextFrame(StemMp3Reader *reader) {
+    const StemSeekTable *table = &reader->table;
+    if (reader->nextFrame >= table->frameCount) return -1;
+
+    uint32_t start = table->frameOffsets[reader->nextFrame];
+    uint32_t size = table->frameOffsets[reader->nextFrame + 1] - start;
+    if (size > MAX_FRAME_BYTES) size = MAX_FRAME_BYTES;   // Junk after the frame is not needed
+    reader->nextFrame++;
+
+    // Frames are contiguous, so this only seeks when junk was skipped between them
+    int ok = ftell(reader->file) == (long)start || fseek(reader->file, (long)start, SEEK_SET) == 0;
+    ok = ok && fread(reader->frameBytes, 1, size, reader->file) == size;
+
+    StemMp3FrameInfo info;
+    ok = ok && StemMp3DecodeFrame(reader->decoder, reader->frameBytes, size, reader->pcm, &info) == 0 &&
+         info.channelCount == table->channelCount && info.samplesPerFrame == table->samplesPerFrame;
+    if (!ok) {
+        memset(reader->pcm, 0, sizeof(float) * table->samplesPerFrame * table->channelCount);
+    }
+    reader->pcmOffset = 0;
+    reader->pcmCount = table->samplesPerFrame;
+    return 0;
+}
+
+size_t StemMp3ReaderRead(StemMp3Reader *reader, float *interleaved, size_t maxFrames) {
+    size_t produced = 0;
+    uint16_t channels = reader->channelCount;
+    while (produced < maxFrames && reader->position < reader->frameCount) {
+        if (reader->pcmOffset == reader->pcmCount && DecodeNextFrame(reader) != 0) break;
+
+        uint32_t available = reader->pcmCount - reader->pcmOffset;
+        if (reader->discardRemaining > 0) {
+            uint32_t drop = available < reader->discardRemaining ? available : reader->discardRemaining;
+            reader->pcmOffset += drop;
+            reader->discardRemaining -= drop;
+            continue;
+        }
+
+        size_t count = available;
+        if (count > maxFrames - produced) count = maxFrames - produced;
+        if (count > reader->frameCount - reader->position) count = (size_t)(reader->frameCount - reader->position);
+        memcpy(interleaved + produced * channels, reader->pcm + (size_t)reader->pcmOffset * channels,
+               count * channels * sizeof(float));
+        reader->pcmOffset += (uint32_t)count;
+        reader->position += count;
+        produced += count;
+    }
+    return produced;
+}
+
+size_t StemMp3ReaderBufferBytes(const StemMp3Reader *reader) {
+    const StemSeekTable *table = &reader->table;
+    return sizeof(StemMp3Decoder) + MAX_FRAME_BYTES +
+           sizeof(float) * STEM_MP3_MAX_SAMPLES_PER_FRAME * STEM_MP3_MAX_CHANNELS +
+           (table->frameOffsets ? (table->frameCount + 1) * sizeof(uint32_t) : 0) +
+           (table->reservoirFrames ? table->frameCount + 1 : 0);
+}
+
+void StemMp3ReaderClose(StemMp3Reader *reader) {
+    if (reader->file) fclose(reader->file);
+    StemSeekTableFree(&reader->table);
+    free(reader->decoder);
+    free(reader->frameBytes);
+    free(reader->pcm);
+    memset(reader, 0, sizeof(*reader));
+}
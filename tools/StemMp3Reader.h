@@ -0,0 +1,54 @@
+//
+//  StemMp3Reader.h
+//  Streaming, sample-accurate MP3 stem reader for the batch tools
+//
+//  Frames are read from disk one at a time through the stem's seek table, so
+//  memory stays fixed regardless of song length. Output starts at the stem's
+//  first playable sample (encoder delay and decoder delay trimmed) and ends
+//  after table.sampleCount samples, matching what the app plays.
+//
+
+#ifndef STEM_MP3_READER_H
+#define STEM_MP3_READER_H
+
+#include "../src/StemSeekTable.h"
+#include "StemMp3Decoder.h"
+
+#include <stdio.h>
+
+typedef struct {
+    FILE *file;
+    StemSeekTable table;
+    uint32_t sampleRate;
+    uint16_t channelCount;
+    uint64_t frameCount;        // Playable sample frames (table.sampleCount)
+
+    StemMp3Decoder *decoder;
+    uint8_t *frameBytes;
+    float *pcm;                 // One decoded MP3 frame, interleaved
+    uint32_t pcmOffset;         // Sample frames of pcm already consumed
+    uint32_t pcmCount;
+    uint32_t nextFrame;         // Next MP3 frame to decode
+    uint32_t discardRemaining;  // Decoder output still to drop after a seek
+    uint64_t position;          // Next sample frame Read returns
+} StemMp3Reader;
+
+// Loads or builds <path>.seek and positions at sample 0. Returns 0 on success,
+// -1 if the file is missing or has no Layer III frames.
+int StemMp3ReaderOpen(StemMp3Reader *reader, const char *path);
+
+// Repositions so the next Read starts exactly at `sample`. Only the frames the
+// sample depends on are decoded. Returns -1 if the sample is past the end.
+int StemMp3ReaderSeek(StemMp3Reader *reader, uint64_t sample);
+
+// Reads up to maxFrames interleaved float frames. Returns frames read, 0 at end.
+// A frame that fails to decode reads as silence so timing is preserved.
+size_t StemMp3ReaderRead(StemMp3Reader *reader, float *interleaved, size_t maxFrames);
+
+// Heap bytes the reader holds while streaming: decoder state, frame and PCM
+// buffers and the seek table.
+size_t StemMp3ReaderBufferBytes(const StemMp3Reader *reader);
+
+void StemMp3ReaderClose(StemMp3Reader *reader);
+
+#endif
@@ -0,0 +1,143 @@
+//
+//  StemWorkPool.c
+//  Work-stealing thread pool for the batch tools (pthreads)
+//
+
+#include "StemWorkPool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// One deque per worker, padded so neighbouring locks don't share a cache line
+typedef struct {
+    pthread_mutex_t lock;
+    size_t front;   // Owner takes from here
+    size_t back;    // Thieves take from here (exclusive)
+    char padding[64];
+} WorkDeque;
+
+typedef struct {
+    WorkDeque *deques;
+    unsigned workerCount;
+    StemWorkFunction function;
+    void *context;
+    StemWorkerStats *stats;
+} WorkPool;
+
+typedef struct {
+    WorkPool *pool;
+    unsigned index;
+} WorkerArgs;
+
+static int TakeOwn(WorkDeque *deque, size_t *job) {
+    int found = 0;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->front < deque->back) {
+        *job = deque->front++;
+        found = 1;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static int Steal(WorkPool *pool, unsigned thief, size_t *job) {
+    // Jobs are never added after start, so once every deque is empty we are done
+    for (;;) {
+        unsigned victim = thief;
+        size_t most = 0;
+        for (unsigned i = 0; i < pool->workerCount; i++) {
+            if (i == thief) continue;
+            WorkDeque *deque = &pool->deques[i];
+            pthread_mutex_lock(&deque->lock);
+            size_t remaining = deque->back - deque->front;
+            pthread_mutex_unlock(&deque->lock);
+            if (remaining > most) {
+                most = remaining;
+                victim = i;
+            }
+        }
+        if (most == 0) return 0;
+
+        WorkDeque *deque = &pool->deques[victim];
+        int found = 0;
+        pthread_mutex_lock(&deque->lock);
+        if (deque->front < deque->back) {
+            *job = --deque->back;
+            found = 1;
+        }
+        pthread_mutex_unlock(&deque->lock);
+        if (found) return 1;
+    }
+}
+
+static void *WorkerMain(void *argument) {
+    WorkerArgs *args = argument;
+    WorkPool *pool = args->pool;
+    WorkDeque *own = &pool->deques[args->index];
+    StemWorkerStats *stats = pool->stats ? &pool->stats[args->index] : NULL;
+
+    size_t job;
+    for (;;) {
+        int stolen = 0;
+        if (!TakeOwn(own, &job)) {
+            if (!Steal(pool, args->index, &job)) break;
+            stolen = 1;
+        }
+        pool->function(pool->context, job, args->index);
+        if (stats) {
+            stats->executed++;
+            stats->stolen += stolen;
+        }
+    }
+    return NULL;
+}
+
+int StemWorkPoolRun(size_t jobCount, unsigned workerCount, StemWorkFunction function, void *context,
+                    StemWorkerStats *stats) {
+    if (workerCount == 0) workerCount = 1;
+    if (stats) memset(stats, 0, workerCount * sizeof(StemWorkerStats));
+
+    WorkPool pool = {0};
+    pool.deques = calloc(workerCount, sizeof(WorkDeque));
+    pthread_t *threads = calloc(workerCount, sizeof(pthread_t));
+    WorkerArgs *args = calloc(workerCount, sizeof(WorkerArgs));
+    if (!pool.deques || !threads || !args) {
+        free(pool.deques);
+        free(threads);
+        free(args);
+        return -1;
+    }
+    pool.workerCount = workerCount;
+    pool.function = function;
+    pool.context = context;
+    pool.stats = stats;
+
+    for (unsigned i = 0; i < workerCount; i++) {
+        pthread_mutex_init(&pool.deques[i].lock, NULL);
+        pool.deques[i].front = jobCount * i / workerCount;
+        pool.deques[i].back = jobCount * (i + 1) / workerCount;
+        args[i].pool = &pool;
+        args[i].index = i;
+    }
+
+    // Worker 0 runs on the calling thread. Deques of workers whose thread could
+    // not be created are left for the others to steal from, and the calling
+    // thread does not return until every deque is empty.
+    unsigned started = 1;
+    for (; started < workerCount; started++) {
+        if (pthread_create(&threads[started], NULL, WorkerMain, &args[started]) != 0) break;
+    }
+    WorkerMain(&args[0]);
+    for (unsigned i = 1; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (unsigned i = 0; i < workerCount; i++) {
+        pthread_mutex_destroy(&pool.deques[i].lock);
+    }
+    free(pool.deques);
+    free(threads);
+    free(args);
+    return (int)(workerCount - started);
+}
@@ -0,0 +1,27 @@
+//
+//  StemWorkPool.h
+//  Work-stealing thread pool for the batch tools (pthreads)
+//
+
+#ifndef STEM_WORK_POOL_H
+#define STEM_WORK_POOL_H
+
+#include <stddef.h>
+
+typedef void (*StemWorkFunction)(void *context, size_t jobIndex, unsigned workerIndex);
+
+typedef struct {
+    size_t executed;
+    size_t stolen;   // Jobs taken from another worker's deque
+} StemWorkerStats;
+
+// Runs jobs [0, jobCount) on workerCount threads. Each worker starts with a
+// contiguous slice and works it front to back; idle workers steal single jobs
+// from the back of the fullest deque. stats, if given, has workerCount entries.
+// Returns 0 when every worker ran, -1 if the pool could not be allocated (no
+// job ran), or the number of workers whose thread could not be started: their
+// jobs still ran, on the calling thread and the workers that did start.
+int StemWorkPoolRun(size_t jobCount, unsigned workerCount, StemWorkFunction function, void *context,
+                    StemWorkerStats *stats);
+
+#endif
@@ -0,0 +1,268 @@
+//
+//  fader-bench.c
+//  Synthetic multi-finger touch load against the display-rate fader model
+//
+//  Replays the same touch stream two ways: publishing on every touch (the old
+//  setValue: -> redraw -> reformat-status path) and publishing once per display
+//  frame. Reports view updates per frame, status reformats per frame and the
+//  CPU the model + status formatting costs per second of input.
+//
+
+#include "../src/StemFaderModel.h"
+#include "../src/StemMixer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+enum { EventValue, EventActive, EventMuted };
+
+typedef struct {
+    uint32_t tick;    // Input tick (1 / inputRate seconds)
+    uint8_t kind;
+    uint8_t index;
+    float value;
+} TouchEvent;
+
+typedef struct {
+    uint64_t frames;
+    uint64_t updates;         // Dirty fader entries handed to the views
+    uint64_t maxUpdates;      // Most in one frame
+    uint64_t styleUpdates;    // Entries needing a near-full redraw
+    uint64_t statusFormats;
+    double cpuSeconds;
+    StemFaderState final[STEM_FADER_MODEL_MAX_FADERS];
+} PathStats;
+
+static double CpuSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Small LCG so runs are reproducible across platforms
+static uint32_t gSeed = 12345;
+static float RandomUnit(void) {
+    gSeed = gSeed * 1664525u + 1013904223u;
+    return (gSeed >> 8) / 16777216.0f;
+}
+
+#pragma mark - Synthetic Input
+
+// Each finger rides its own fader with a slow sweep plus sensor jitter, settles
+// and lifts briefly every few seconds, and one fader's mute toggles every seven
+// seconds.
+static TouchEvent *GenerateTouches(unsigned fingers, unsigned faders, double seconds, double inputRate,
+                                   size_t *outCount) {
+    uint32_t ticks = (uint32_t)(seconds * inputRate);
+    size_t capacity = (size_t)ticks * (fingers * 2 + 1) + fingers + 16;
+    TouchEvent *events = malloc(capacity * sizeof(TouchEvent));
+    if (!events) return NULL;
+
+    size_t count = 0;
+    uint32_t muteInterval = (uint32_t)(7.0 * inputRate);
+    int down[64] = {0};
+    int muted[STEM_FADER_MODEL_MAX_FADERS] = {0};
+    for (uint32_t tick = 0; tick < ticks; tick++) {
+        double t = tick / inputRate;
+        for (unsigned f = 0; f < fingers; f++) {
+            unsigned fader = f % faders;
+            double period = 2.5 + 0.37 * f;
+            double phase = fmod(t + 0.11 * f, period);
+            int touching = phase > 0.2;
+
+            if (touching != down[f]) {
+                events[count++] = (TouchEvent){tick, EventActive, (uint8_t)fader, (float)touching};
+                down[f] = touching;
+            }
+            if (!touching) continue;
+
+            // The finger settles for a moment before lifting, leaving only
+            // sub-resolution jitter for the knob to catch up on
+            double settleAt = t - phase + period - 0.15;
+            if (seconds - 0.15 < settleAt) settleAt = seconds - 0.15;
+            double at = t < settleAt ? t : settleAt;
+            double sweep = 50.0 + 45.0 * sin(2.0 * M_PI * (0.3 + 0.23 * f) * at + f);
+            float value = (float)(sweep + (RandomUnit() - 0.5f) * 0.4f);
+            events[count++] = (TouchEvent){tick, EventValue, (uint8_t)fader, value};
+        }
+        if (tick > 0 && muteInterval > 0 && tick % muteInterval == 0) {
+            unsigned fader = (tick / muteInterval) % faders;
+            muted[fader] = !muted[fader];
+            events[count++] = (TouchEvent){tick, EventMuted, (uint8_t)fader, (float)muted[fader]};
+        }
+    }
+    // Session ends with every finger lifted, as a real drag does
+    for (unsigned f = 0; f < fingers; f++) {
+        if (down[f]) events[count++] = (TouchEvent){ticks, EventActive, (uint8_t)(f % faders), 0.0f};
+    }
+    *outCount = count;
+    return events;
+}
+
+static void ApplyEvent(StemFaderModel *model, const TouchEvent *event) {
+    switch (event->kind) {
+        case EventValue: StemFaderModelSetValue(model, event->index, event->value); break;
+        case EventActive: StemFaderModelSetActive(model, event->index, event->value != 0.0f); break;
+        case EventMuted: StemFaderModelSetMuted(model, event->index, event->value != 0.0f); break;
+    }
+}
+
+#pragma mark - Paths
+
+static void Publish(StemFaderModel *model, PathStats *stats, int alwaysFormat, char *status, size_t statusSize) {
+    StemFaderFrame frame;
+    size_t count = StemFaderModelPublish(model, &frame);
+    stats->frames++;
+    stats->updates += count;
+    if (count > stats->maxUpdates) stats->maxUpdates = count;
+    for (size_t i = 0; i < count; i++) {
+        if (frame.flags[i] & StemFaderDirtyStyle) stats->styleUpdates++;
+    }
+    if (frame.statusDirty || alwaysFormat) {
+        StemFaderModelFormatStatus(model, status, statusSize);
+        stats->statusFormats++;
+    }
+}
+
+// Old behaviour: every touch event redraws its fader and rebuilds the whole status line
+static void RunPerTouch(const TouchEvent *events, size_t count, unsigned faders, double seconds,
+                        double displayRate, PathStats *stats) {
+    StemFaderModel model;
+    StemFaderModelInit(&model, faders, STEM_MIXER_DEFAULT_FADER, 0.0f);
+    char status[256];
+    PathStats perEvent = {0};
+
+    double start = CpuSeconds();
+    for (size_t i = 0; i < count; i++) {
+        ApplyEvent(&model, &events[i]);
+        Publish(&model, &perEvent, 1, status, sizeof(status));
+    }
+    stats->cpuSeconds = CpuSeconds() - start;
+
+    // Express per display frame so both paths read on the same scale
+    stats->frames = (uint64_t)(seconds * displayRate);
+    stats->updates = perEvent.updates;
+    stats->styleUpdates = perEvent.styleUpdates;
+    stats->statusFormats = perEvent.statusFormats;
+    stats->maxUpdates = 0;
+
+    // Worst display frame: most events landing inside one frame interval
+    double ticksPerFrame = (double)(events[count - 1].tick + 1) / stats->frames;
+    uint64_t inFrame = 0, frameIndex = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t f = (uint64_t)(events[i].tick / ticksPerFrame);
+        if (f != frameIndex) {
+            if (inFrame > stats->maxUpdates) stats->maxUpdates = inFrame;
+            frameIndex = f;
+            inFrame = 0;
+        }
+        inFrame++;
+    }
+    if (inFrame > stats->maxUpdates) stats->maxUpdates = inFrame;
+    memcpy(stats->final, model.published, sizeof(stats->final));
+}
+
+static void RunCoalesced(const TouchEvent *events, size_t count, unsigned faders, double inputRate,
+                         double displayRate, float resolution, PathStats *stats) {
+    StemFaderModel model;
+    StemFaderModelInit(&model, faders, STEM_MIXER_DEFAULT_FADER, resolution);
+    char status[256];
+
+    double frameTicks = inputRate / displayRate;
+    double nextFrame = frameTicks;
+
+    double start = CpuSeconds();
+    for (size_t i = 0; i < count; i++) {
+        while (events[i].tick >= nextFrame) {
+            Publish(&model, stats, 0, status, sizeof(status));
+            nextFrame += frameTicks;
+        }
+        ApplyEvent(&model, &events[i]);
+    }
+    Publish(&model, stats, 0, status, sizeof(status));
+    stats->cpuSeconds = CpuSeconds() - start;
+
+    // No extra flush: the frame after the last lift must already show every
+    // held-back value, at the configured resolution
+    memcpy(stats->final, model.published, sizeof(stats->final));
+}
+
+#pragma mark - Main
+
+static void PrintPath(const char *name, const PathStats *stats, double seconds) {
+    double frames = stats->frames ? (double)stats->frames : 1.0;
+    printf("%-10s %13.2f %6llu %13.2f %12.2f %11.1f\n", name,
+           stats->updates / frames, (unsigned long long)stats->maxUpdates,
+           stats->statusFormats / frames, stats->styleUpdates / frames,
+           1e6 * stats->cpuSeconds / seconds);
+}
+
+static void Usage(const char *program) {
+    fprintf(stderr, "usage: %s [-f fingers] [-n faders] [-s seconds] [-i input_hz] [-d display_hz] [-r resolution]\n",
+            program);
+}
+
+int main(int argc, char *argv[]) {
+    unsigned fingers = 5, faders = 5;
+    double seconds = 600.0, inputRate = 1000.0, displayRate = 60.0;
+    float resolution = 0.5f;
+    int opt;
+    while ((opt = getopt(argc, argv, "f:n:s:i:d:r:h")) != -1) {
+        switch (opt) {
+            case 'f': fingers = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'n': faders = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 's': seconds = strtod(optarg, NULL); break;
+            case 'i': inputRate = strtod(optarg, NULL); break;
+            case 'd': displayRate = strtod(optarg, NULL); break;
+            case 'r': resolution = strtof(optarg, NULL); break;
+            default: Usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (fingers < 1 || fingers > 64 || faders < 1 || faders > STEM_FADER_MODEL_MAX_FADERS ||
+        seconds <= 0.0 || inputRate <= 0.0 || displayRate <= 0.0 || optind != argc) {
+        Usage(argv[0]);
+        return 2;
+    }
+
+    size_t count = 0;
+    TouchEvent *events = GenerateTouches(fingers, faders, seconds, inputRate, &count);
+    if (!events || count == 0) {
+        fprintf(stderr, "could not generate input\n");
+        free(events);
+        return 1;
+    }
+
+    PathStats perTouch = {0}, coalesced = {0};
+    RunPerTouch(events, count, faders, seconds, displayRate, &perTouch);
+    RunCoalesced(events, count, faders, inputRate, displayRate, resolution, &coalesced);
+
+    printf("%u fingers on %u faders, %.0f Hz input, %.0f Hz display, %.0f s simulated (%zu touch writes)\n\n",
+           fingers, faders, inputRate, displayRate, seconds, count);
+    printf("%-10s %13s %6s %13s %12s %11s\n", "path", "updates/frame", "max", "status/frame", "style/frame",
+           "cpu us/s");
+    PrintPath("per-touch", &perTouch, seconds);
+    PrintPath("coalesced", &coalesced, seconds);
+
+    double reduction = coalesced.updates ? (double)perTouch.updates / coalesced.updates : 0.0;
+    printf("\n%.1fx fewer view updates, %.1fx less model/status CPU\n", reduction,
+           coalesced.cpuSeconds > 0.0 ? perTouch.cpuSeconds / coalesced.cpuSeconds : 0.0);
+
+    // Both paths must land on the same final state
+    int consistent = 1;
+    for (unsigned i = 0; i < faders; i++) {
+        const StemFaderState *a = &perTouch.final[i], *b = &coalesced.final[i];
+        if (a->value != b->value || a->active != b->active || a->muted != b->muted) consistent = 0;
+    }
+    printf("final state %s\n", consistent ? "consistent" : "MISMATCH");
+
+    free(events);
+    return consistent ? 0 : 1;
+}
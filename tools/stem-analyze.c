@@ -0,0 +1,374 @@
+//
+//  stem-analyze.c
+//  Batch tempo/beat/key analysis over cached song directories
+//
+//  Each song directory holds its stems as WAV files (drums.wav, bass.wav, ...)
+//  or as the app's cached MP3s, so the app finds the analysis already done.
+//  The result is written to analysis.bin in the same directory and songs whose
+//  sidecar still matches their stems are skipped unless -f is given. An
+//  optional annotation.txt ("bpm 128" / "key A minor") is compared against the
+//  result for accuracy; with -c any miss fails the run.
+//
+
+#include "../src/StemAnalysis.h"
+#include "../src/StemWav.h"
+#include "StemMp3Reader.h"
+
+#include <dirent.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_STEMS STEM_ANALYSIS_MAX_STEMS
+
+typedef struct {
+    char **songDirs;
+    size_t songCount;
+    int force;
+    atomic_size_t nextSong;
+    pthread_mutex_t reportLock;
+
+    // Aggregates, guarded by reportLock
+    size_t analysed;
+    size_t skipped;
+    size_t failed;
+    double audioSeconds;
+    size_t annotatedTempo;
+    size_t tempoHits;
+    size_t tempoOctaveHits;
+    size_t annotatedKey;
+    size_t keyHits;
+    size_t misses;            // Annotated songs with a wrong tempo or key
+} BatchState;
+
+typedef struct {
+    float bpm;
+    int keyTonic;
+    StemKeyMode keyMode;
+    int hasBpm;
+    int hasKey;
+} Annotation;
+
+static double NowSeconds(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int ParseTonic(const char *name) {
+    static const char *const sharps[12] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+    static const char *const flats[12] = {"C", "Db", "D", "Eb", "E", "F", "Gb", "G", "Ab", "A", "Bb", "B"};
+    for (int i = 0; i < 12; i++) {
+        if (strcmp(name, sharps[i]) == 0 || strcmp(name, flats[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static void ReadAnnotation(const char *songDir, Annotation *annotation) {
+    memset(annotation, 0, sizeof(*annotation));
+
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/annotation.txt", songDir);
+    FILE *file = fopen(path, "r");
+    if (!file) return;
+
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        char tonic[8], mode[8];
+        if (sscanf(line, "bpm %f", &annotation->bpm) == 1) {
+            annotation->hasBpm = 1;
+        } else if (sscanf(line, "key %7s %7s", tonic, mode) == 2) {
+            annotation->keyTonic = ParseTonic(tonic);
+            annotation->keyMode = strcmp(mode, "minor") == 0 ? StemKeyModeMinor : StemKeyModeMajor;
+            annotation->hasKey = annotation->keyTonic >= 0;
+        }
+    }
+    fclose(file);
+}
+
+static int ComparePaths(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static int HasExtension(const char *name, const char *extension) {
+    size_t length = strlen(name);
+    return length > 4 && strcasecmp(name + length - 4, extension) == 0;
+}
+
+// Same stem in the other format: "drums.wav" and "drums.mp3"
+static int IsTwin(const char *wavPath, const char *path) {
+    size_t length = strlen(wavPath);
+    return strlen(path) == length && HasExtension(path, ".mp3") && strncmp(wavPath, path, length - 4) == 0;
+}
+
+// Collects the directory's WAV and MP3 stems, sorted. A stem present in both
+// formats is taken as MP3, the format the app caches and analyses. Returns the
+// count, 0 if none or if there are more than MAX_STEMS.
+static size_t ListStems(const char *songDir, char **paths) {
+    DIR *dir = opendir(songDir);
+    if (!dir) return 0;
+
+    char **found = NULL;
+    size_t count = 0, capacity = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir))) {
+        if (!HasExtension(entry->d_name, ".wav") && !HasExtension(entry->d_name, ".mp3")) continue;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            char **grown = realloc(found, capacity * sizeof(char *));
+            if (!grown) break;
+            found = grown;
+        }
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/%s", songDir, entry->d_name);
+        if (!(found[count] = strdup(path))) break;
+        count++;
+    }
+    closedir(dir);
+
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        int twin = 0;
+        for (size_t j = 0; j < count && HasExtension(found[i], ".wav"); j++) twin |= IsTwin(found[i], found[j]);
+        if (twin) {
+            fprintf(stderr, "%s: also cached as MP3, using that\n", found[i]);
+            free(found[i]);
+        } else {
+            found[kept++] = found[i];
+        }
+    }
+
+    if (kept > MAX_STEMS) {
+        fprintf(stderr, "%s: more than %d stems\n", songDir, MAX_STEMS);
+        for (size_t i = 0; i < kept; i++) free(found[i]);
+        kept = 0;
+    }
+    qsort(found, kept, sizeof(char *), ComparePaths);
+    memcpy(paths, found, kept * sizeof(char *));
+    free(found);
+    return kept;
+}
+
+// Decodes a whole MP3 stem and mixes it down to mono, like StemWavReadMono
+static int ReadMp3Mono(const char *path, float **outSamples, size_t *outFrames, double *outRate) {
+    StemMp3Reader reader;
+    if (StemMp3ReaderOpen(&reader, path) != 0) return -1;
+
+    size_t frames = (size_t)reader.frameCount;
+    uint16_t channels = reader.channelCount;
+    size_t blockFrames = 4096;
+    float *mono = malloc((frames ? frames : 1) * sizeof(float));
+    float *block = malloc(blockFrames * channels * sizeof(float));
+    size_t done = 0;
+    while (mono && block && done < frames) {
+        size_t got = StemMp3ReaderRead(&reader, block, blockFrames);
+        if (got == 0) break;
+        for (size_t f = 0; f < got; f++) {
+            float sum = 0.0f;
+            for (uint16_t c = 0; c < channels; c++) sum += block[f * channels + c];
+            mono[done + f] = sum / channels;
+        }
+        done += got;
+    }
+    *outRate = reader.sampleRate;
+    StemMp3ReaderClose(&reader);
+    free(block);
+
+    if (!mono || done != frames) {
+        free(mono);
+        return -1;
+    }
+    *outSamples = mono;
+    *outFrames = frames;
+    return 0;
+}
+
+// Loads the stems as mono. Returns how many loaded; a stem that fails to decode
+// or has a different sample rate is left out.
+static size_t LoadStems(char *const *paths, size_t pathCount, StemAnalysisInput *inputs, float **buffers,
+                        double *sampleRate) {
+    size_t count = 0;
+    for (size_t i = 0; i < pathCount; i++) {
+        double rate = 0.0;
+        size_t frames = 0;
+        int read = HasExtension(paths[i], ".mp3") ? ReadMp3Mono(paths[i], &buffers[count], &frames, &rate)
+                                                   : StemWavReadMono(paths[i], &buffers[count], &frames, &rate);
+        if (read != 0) {
+            fprintf(stderr, "%s: unreadable stem\n", paths[i]);
+            continue;
+        }
+        if (count > 0 && rate != *sampleRate) {
+            fprintf(stderr, "%s: sample rate mismatch, skipping stem\n", paths[i]);
+            free(buffers[count]);
+            continue;
+        }
+
+        const char *name = strrchr(paths[i], '/');
+        *sampleRate = rate;
+        inputs[count].samples = buffers[count];
+        inputs[count].frameCount = frames;
+        inputs[count].role = StemRoleForName(name ? name + 1 : paths[i]);
+        count++;
+    }
+    return count;
+}
+
+static void AnalyseSong(BatchState *state, const char *songDir) {
+    char sidecarPath[4096];
+    snprintf(sidecarPath, sizeof(sidecarPath), "%s/%s", songDir, STEM_ANALYSIS_SIDECAR_NAME);
+
+    char *paths[MAX_STEMS];
+    size_t pathCount = ListStems(songDir, paths);
+    StemAnalysisSources sources;
+    int listed = pathCount > 0 && StemAnalysisSourcesForPaths((const char *const *)paths, pathCount, &sources) == 0;
+
+    // A sidecar only counts as cached while it matches the stems on disk
+    StemAnalysisResult result;
+    if (listed && !state->force && StemAnalysisReadSidecar(sidecarPath, &sources, &result) == 0) {
+        StemAnalysisResultFree(&result);
+        for (size_t i = 0; i < pathCount; i++) free(paths[i]);
+        pthread_mutex_lock(&state->reportLock);
+        state->skipped++;
+        pthread_mutex_unlock(&state->reportLock);
+        return;
+    }
+
+    StemAnalysisInput inputs[MAX_STEMS];
+    float *buffers[MAX_STEMS];
+    double sampleRate = 0.0;
+    size_t stemCount = listed ? LoadStems(paths, pathCount, inputs, buffers, &sampleRate) : 0;
+
+    // Every stem has to contribute, or the sidecar would cache a partial result
+    int ok = listed && stemCount == pathCount && StemAnalysisRun(inputs, stemCount, sampleRate, &result) == 0;
+    if (ok && StemAnalysisWriteSidecar(sidecarPath, &result, &sources) != 0) {
+        StemAnalysisResultFree(&result);
+        ok = 0;
+    }
+
+    for (size_t s = 0; s < stemCount; s++) free(buffers[s]);
+    for (size_t i = 0; i < pathCount; i++) free(paths[i]);
+
+    Annotation annotation;
+    if (ok) ReadAnnotation(songDir, &annotation);
+
+    pthread_mutex_lock(&state->reportLock);
+    if (!ok) {
+        state->failed++;
+        fprintf(stderr, "FAIL %s\n", songDir);
+    } else {
+        state->analysed++;
+        state->audioSeconds += result.duration;
+
+        const char *tempoMark = "";
+        if (annotation.hasBpm) {
+            double ratio = result.bpm / annotation.bpm;
+            int hit = fabs(ratio - 1.0) <= 0.04;
+            int octaveHit = hit || fabs(ratio - 2.0) <= 0.08 || fabs(ratio - 0.5) <= 0.02;
+            state->annotatedTempo++;
+            state->tempoHits += hit;
+            state->tempoOctaveHits += octaveHit;
+            tempoMark = hit ? " ok" : octaveHit ? " octave" : " MISS";
+            state->misses += !hit;
+        }
+        const char *keyMark = "";
+        if (annotation.hasKey) {
+            int hit = annotation.keyTonic == result.keyTonic && annotation.keyMode == result.keyMode;
+            state->annotatedKey++;
+            state->keyHits += hit;
+            keyMark = hit ? " ok" : " MISS";
+            state->misses += !hit;
+        }
+
+        printf("%s: %.1f BPM%s (conf %.2f), %u beats, %s%s (conf %.2f)\n",
+               songDir, result.bpm, tempoMark, result.tempoConfidence, result.beatCount,
+               StemAnalysisKeyName(result.keyTonic, result.keyMode), keyMark, result.keyConfidence);
+        StemAnalysisResultFree(&result);
+    }
+    pthread_mutex_unlock(&state->reportLock);
+}
+
+static void *Worker(void *context) {
+    BatchState *state = context;
+    for (;;) {
+        size_t index = atomic_fetch_add(&state->nextSong, 1);
+        if (index >= state->songCount) break;
+        AnalyseSong(state, state->songDirs[index]);
+    }
+    return NULL;
+}
+
+static void Usage(const char *program) {
+    fprintf(stderr, "usage: %s [-j threads] [-f] [-c] song_dir...\n", program);
+    fprintf(stderr, "  -j N  worker threads (default: online CPU count)\n");
+    fprintf(stderr, "  -f    re-analyse songs that already have %s\n", STEM_ANALYSIS_SIDECAR_NAME);
+    fprintf(stderr, "  -c    check: exit non-zero if any annotated tempo or key is missed\n");
+}
+
+int main(int argc, char *argv[]) {
+    long threadCount = sysconf(_SC_NPROCESSORS_ONLN);
+    int force = 0, check = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:fch")) != -1) {
+        switch (opt) {
+            case 'j': threadCount = strtol(optarg, NULL, 10); break;
+            case 'f': force = 1; break;
+            case 'c': check = 1; break;
+            default: Usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (optind >= argc) {
+        Usage(argv[0]);
+        return 2;
+    }
+
+    BatchState state;
+    memset(&state, 0, sizeof(state));
+    state.songDirs = argv + optind;
+    state.songCount = (size_t)(argc - optind);
+    state.force = force;
+    atomic_init(&state.nextSong, 0);
+    pthread_mutex_init(&state.reportLock, NULL);
+
+    if (threadCount < 1) threadCount = 1;
+    if ((size_t)threadCount > state.songCount) threadCount = (long)state.songCount;
+
+    double wallStart = NowSeconds(CLOCK_MONOTONIC);
+    double cpuStart = NowSeconds(CLOCK_PROCESS_CPUTIME_ID);
+
+    pthread_t *threads = malloc((size_t)threadCount * sizeof(pthread_t));
+    for (long i = 0; i < threadCount; i++) pthread_create(&threads[i], NULL, Worker, &state);
+    for (long i = 0; i < threadCount; i++) pthread_join(threads[i], NULL);
+    free(threads);
+
+    double wall = NowSeconds(CLOCK_MONOTONIC) - wallStart;
+    double cpu = NowSeconds(CLOCK_PROCESS_CPUTIME_ID) - cpuStart;
+
+    printf("\n%zu analysed, %zu cached, %zu failed on %ld threads\n",
+           state.analysed, state.skipped, state.failed, threadCount);
+    printf("wall %.2fs, cpu %.2fs, %.1f songs per core-minute, %.0fx real time per core\n",
+           wall, cpu,
+           cpu > 0.0 ? state.analysed / (cpu / 60.0) : 0.0,
+           cpu > 0.0 ? state.audioSeconds / cpu : 0.0);
+    if (state.annotatedTempo) {
+        printf("tempo accuracy: %.1f%% exact, %.1f%% allowing octave errors (%zu annotated)\n",
+               100.0 * state.tempoHits / state.annotatedTempo,
+               100.0 * state.tempoOctaveHits / state.annotatedTempo, state.annotatedTempo);
+    }
+    if (state.annotatedKey) {
+        printf("key accuracy: %.1f%% (%zu annotated)\n",
+               100.0 * state.keyHits / state.annotatedKey, state.annotatedKey);
+    }
+
+    pthread_mutex_destroy(&state.reportLock);
+    if (check && state.misses) {
+        fprintf(stderr, "%zu annotated song(s) missed\n", state.misses);
+        return 1;
+    }
+    return state.failed ? 1 : 0;
+}
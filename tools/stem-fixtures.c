@@ -0,0 +1,213 @@
+//
+//  stem-fixtures.c
+//  Generates annotated song directories for `make check`
+//
+//  Each song has a drums.wav built from a one-bar, sixteen-step pattern, an
+//  other.wav playing a chord progression (one chord per bar) and a bass.wav
+//  playing the chord roots, with annotation.txt. Besides plain click tracks,
+//  the set includes swung and syncopated grooves whose busiest voice runs at
+//  twice the beat (octave errors) and progressions whose strongest chords
+//  belong to the relative key (mode errors).
+//
+
+#include "../src/StemWav.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define FIXTURE_RATE 22050
+#define FIXTURE_SECONDS 20
+#define STEPS_PER_BAR 16
+#define MAX_CHORDS 4
+#define MAX_CHORD_NOTES 4
+
+typedef enum {
+    VoiceClick = 0,     // 1.8 kHz tick
+    VoiceKick,          // Pitch-dropping sine thump
+    VoiceSnare,         // Noise burst with a body tone
+    VoiceHat,           // Short high noise tick
+    VoiceCount
+} Voice;
+
+typedef struct {
+    int root;                       // MIDI note
+    int intervals[MAX_CHORD_NOTES]; // Semitones above the root, 0-terminated after the first
+} Chord;
+
+typedef struct {
+    const char *name;
+    double bpm;
+    const char *key;
+    double swing;                   // 0 straight, 1 triplet swing on the off-beat eighths
+    // One bar per voice: 'X' accent, 'x' hit, '.' rest
+    const char *pattern[VoiceCount];
+    Chord chords[MAX_CHORDS];       // One per bar, repeating
+    size_t chordCount;
+} Fixture;
+
+#define MAJOR {0, 4, 7}
+#define MINOR {0, 3, 7}
+
+static const Fixture kFixtures[] = {
+    {"click-96-a-minor", 96.0, "A minor", 0.0,
+     {"X...x...x...x...", NULL, NULL, NULL},
+     {{57, MINOR}}, 1},
+    {"click-132-eb-major", 132.0, "Eb major", 0.0,
+     {"X...x...x...x...", NULL, NULL, NULL},
+     {{63, MAJOR}}, 1},
+    {"click-75-f#-minor", 75.0, "F# minor", 0.0,
+     {"X...x...x...x...", NULL, NULL, NULL},
+     {{54, MINOR}}, 1},
+
+    // Swung hats on every eighth and a kick pushed onto the "and" of two.
+    // i - iv - V - i in D harmonic minor: the V chord (A major) brings C#.
+    {"swing-100-d-harmonic-minor", 100.0, "D minor", 1.0,
+     {NULL, "X.....x...x.....", "....X.......X...", "x.x.x.x.x.x.x.x."},
+     {{50, MINOR}, {55, MINOR}, {57, MAJOR}, {50, MINOR}}, 4},
+
+    // Sixteenth hats at a slow tempo, kick anticipating the downbeat.
+    // I - vi - IV - V in C major: the A minor chord pulls towards A minor.
+    {"syncopated-84-c-major", 84.0, "C major", 0.0,
+     {NULL, "X..x......x...x.", "....X.......X...", "xxxxxxxxxxxxxxxx"},
+     {{48, MAJOR}, {57, MINOR}, {53, MAJOR}, {55, MAJOR}}, 4},
+
+    // Fast shuffle: kick on one and three only, swung eighth hats.
+    // i - VI - iv - V in E harmonic minor: B major brings D#.
+    {"shuffle-150-e-harmonic-minor", 150.0, "E minor", 1.0,
+     {NULL, "X.......x.......", "....x.......x...", "x.x.x.x.x.x.x.x."},
+     {{52, MINOR}, {48, MAJOR}, {57, MINOR}, {59, MAJOR}}, 4},
+};
+
+static double NoteHz(int midi) {
+    return 440.0 * pow(2.0, (midi - 69) / 12.0);
+}
+
+static float Noise(uint32_t *state) {
+    *state = *state * 1664525u + 1013904223u;
+    return (float)((*state >> 8) / 8388608.0 - 1.0);
+}
+
+// Start of a sixteenth step within its beat, in beats; swing delays the off-beat eighth
+static double StepOffset(int step, double swing) {
+    double position = (step % 4) / 4.0;
+    double offbeat = 0.5 + swing / 6.0;
+    double swung = position < 0.5 ? position / 0.5 * offbeat : offbeat + (position - 0.5) / 0.5 * (1.0 - offbeat);
+    return step / 4 + swung;
+}
+
+static void AddHit(float *drums, size_t count, size_t start, Voice voice, float gain, uint32_t *noise) {
+    size_t length = (size_t)(FIXTURE_RATE * (voice == VoiceKick ? 0.15 : voice == VoiceSnare ? 0.12 : 0.03));
+    for (size_t i = 0; i < length && start + i < count; i++) {
+        double t = (double)i / FIXTURE_RATE;
+        double sample = 0.0;
+        switch (voice) {
+            case VoiceClick:
+                sample = exp(-t * 150.0) * sin(2.0 * M_PI * 1800.0 * t);
+                break;
+            case VoiceKick:
+                // 120 Hz falling to 50 Hz
+                sample = exp(-t * 25.0) * sin(2.0 * M_PI * (50.0 * t + 70.0 * (1.0 - exp(-t * 30.0)) / 30.0));
+                break;
+            case VoiceSnare:
+                sample = exp(-t * 30.0) * (0.6 * Noise(noise) + 0.4 * sin(2.0 * M_PI * 190.0 * t));
+                break;
+            case VoiceHat:
+                sample = 0.5 * exp(-t * 200.0) * Noise(noise);
+                break;
+            case VoiceCount:
+                break;
+        }
+        drums[start + i] += gain * (float)sample;
+    }
+}
+
+static int WriteStem(const char *dir, const char *stem, const float *samples, size_t count) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s.wav", dir, stem);
+    StemWavWriter writer;
+    if (StemWavWriterOpen(&writer, path, FIXTURE_RATE, 1, 0) != 0) return -1;
+    int ok = StemWavWriterWrite(&writer, samples, count) == 0;
+    return StemWavWriterClose(&writer) == 0 && ok ? 0 : -1;
+}
+
+static int GenerateFixture(const char *outDir, const Fixture *fixture) {
+    char dir[2048];
+    snprintf(dir, sizeof(dir), "%s/%s", outDir, fixture->name);
+    mkdir(dir, 0755);
+
+    size_t count = (size_t)FIXTURE_RATE * FIXTURE_SECONDS;
+    float *drums = calloc(count, sizeof(float));
+    float *other = calloc(count, sizeof(float));
+    float *bass = calloc(count, sizeof(float));
+    int status = -1;
+    if (!drums || !other || !bass) goto done;
+
+    double beat = 60.0 / fixture->bpm;
+    double bar = 4.0 * beat;
+    uint32_t noise = 0x12345678u;
+    for (size_t b = 0; b * bar < FIXTURE_SECONDS; b++) {
+        for (int v = 0; v < VoiceCount; v++) {
+            const char *pattern = fixture->pattern[v];
+            for (int step = 0; pattern && step < STEPS_PER_BAR; step++) {
+                if (pattern[step] == '.') continue;
+                float gain = pattern[step] == 'X' ? 0.9f : 0.6f;
+                double time = b * bar + StepOffset(step, fixture->swing) * beat;
+                if (time < FIXTURE_SECONDS) AddHit(drums, count, (size_t)(time * FIXTURE_RATE), (Voice)v, gain, &noise);
+            }
+        }
+    }
+
+    // Chord tones with a couple of harmonics each; bass plays the root an octave down
+    for (size_t i = 0; i < count; i++) {
+        double t = (double)i / FIXTURE_RATE;
+        const Chord *chord = &fixture->chords[(size_t)(t / bar) % fixture->chordCount];
+        double tones = 0.0;
+        for (int n = 0; n < MAX_CHORD_NOTES && (n == 0 || chord->intervals[n] != 0); n++) {
+            double hz = NoteHz(chord->root + chord->intervals[n]);
+            tones += sin(2.0 * M_PI * hz * t) + 0.3 * sin(4.0 * M_PI * hz * t) + 0.1 * sin(6.0 * M_PI * hz * t);
+        }
+        other[i] = (float)(0.15 * tones);
+        bass[i] = (float)(0.4 * sin(2.0 * M_PI * NoteHz(chord->root - 12) * t));
+    }
+
+    if (WriteStem(dir, "drums", drums, count) != 0 || WriteStem(dir, "other", other, count) != 0 ||
+        WriteStem(dir, "bass", bass, count) != 0) {
+        goto done;
+    }
+
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/annotation.txt", dir);
+    FILE *file = fopen(path, "w");
+    if (!file) goto done;
+    fprintf(file, "bpm %g\nkey %s\n", fixture->bpm, fixture->key);
+    status = fclose(file) == 0 ? 0 : -1;
+
+done:
+    free(drums);
+    free(other);
+    free(bass);
+    if (status != 0) fprintf(stderr, "%s: could not write fixture\n", dir);
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s out_dir\n", argv[0]);
+        return 2;
+    }
+    mkdir(argv[1], 0755);
+
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(kFixtures) / sizeof(kFixtures[0]); i++) {
+        if (GenerateFixture(argv[1], &kFixtures[i]) != 0) failed = 1;
+        else printf("%s/%s\n", argv[1], kFixtures[i].name);
+    }
+    return failed;
+}
@@ -0,0 +1,623 @@
+//
+//  stem-mixdown.c
+//  Headless batch renderer: stems + fader settings -> mixed WAV, across all cores
+//
+//  Job file, one render per line ('#' starts a comment, quote paths with spaces):
+//
+//      <song_dir> <output.wav> [setting...]
+//
+//  Settings address stems by file name without extension (drums, bass, ...):
+//      vocals=mute          mute a stem
+//      drums=80             fader position 0-100 (default 50, as in the app)
+//      solo=drums,bass      mute every stem not listed
+//      vocals@0=100,30=0    automation: fader position at times in seconds
+//
+//  Stems are WAV files or the app's cached MP3s. They are streamed block by
+//  block (decode -> mix -> encode), so memory per worker is bounded by the
+//  block size regardless of song length.
+//
+
+#include "../src/StemMixer.h"
+#include "../src/StemWav.h"
+#include "StemMp3Reader.h"
+#include "StemWorkPool.h"
+
+#include <ctype.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_SETTINGS 16
+#define MAX_NAME 64
+
+typedef struct {
+    char name[MAX_NAME];
+    float value;
+    int hasValue;
+    int muted;
+    StemMixerPoint *automation;
+    size_t automationCount;
+} StemSetting;
+
+typedef struct {
+    char *songDir;
+    char *outputPath;
+    StemSetting settings[MAX_SETTINGS];
+    size_t settingCount;
+    char solo[256];           // Comma-separated stem names, empty = no solo
+
+    // Results
+    int failed;
+    double audioSeconds;
+    double wallSeconds;
+    size_t peakBufferBytes;
+} MixJob;
+
+typedef struct {
+    MixJob *jobs;
+    size_t jobCount;
+    size_t blockFrames;
+    int floatOutput;
+    int quiet;                // Baseline pass: no per-job lines
+    pthread_mutex_t reportLock;
+} MixBatch;
+
+// A stem being streamed from either format
+typedef struct {
+    int isMp3;
+    StemWavReader wav;
+    StemMp3Reader mp3;
+    uint32_t sampleRate;
+    uint16_t channelCount;
+} StemInput;
+
+static double NowSeconds(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#pragma mark - Job File
+
+// Splits a line into whitespace-separated tokens, honouring double quotes. Modifies line.
+static size_t Tokenize(char *line, char **tokens, size_t maxTokens) {
+    size_t count = 0;
+    char *p = line;
+    while (*p && count < maxTokens) {
+        while (isspace((unsigned char)*p)) p++;
+        if (!*p || *p == '#') break;
+
+        if (*p == '"') {
+            tokens[count++] = ++p;
+            while (*p && *p != '"') p++;
+        } else {
+            tokens[count++] = p;
+            while (*p && !isspace((unsigned char)*p)) p++;
+        }
+        if (*p) *p++ = '\0';
+    }
+    return count;
+}
+
+static int CompareByTime(const void *a, const void *b) {
+    double ta = ((const StemMixerPoint *)a)->time;
+    double tb = ((const StemMixerPoint *)b)->time;
+    return (ta > tb) - (ta < tb);
+}
+
+static StemSetting *SettingForName(MixJob *job, const char *name, size_t length) {
+    for (size_t i = 0; i < job->settingCount; i++) {
+        if (strlen(job->settings[i].name) == length && strncasecmp(job->settings[i].name, name, length) == 0) {
+            return &job->settings[i];
+        }
+    }
+    if (job->settingCount == MAX_SETTINGS || length >= MAX_NAME) return NULL;
+
+    StemSetting *setting = &job->settings[job->settingCount++];
+    memset(setting, 0, sizeof(*setting));
+    memcpy(setting->name, name, length);
+    setting->name[length] = '\0';
+    return setting;
+}
+
+static int ParseSetting(MixJob *job, const char *token) {
+    const char *equals = strchr(token, '=');
+    if (!equals || equals == token) return -1;
+
+    if (strncmp(token, "solo=", 5) == 0) {
+        snprintf(job->solo, sizeof(job->solo), "%s", equals + 1);
+        return 0;
+    }
+
+    const char *at = memchr(token, '@', (size_t)(equals - token));
+    StemSetting *setting = SettingForName(job, token, (size_t)((at ? at : equals) - token));
+    if (!setting) return -1;
+
+    if (!at) {
+        if (strcmp(equals + 1, "mute") == 0) {
+            setting->muted = 1;
+            return 0;
+        }
+        char *end;
+        setting->value = strtof(equals + 1, &end);
+        setting->hasValue = 1;
+        return (*end == '\0') ? 0 : -1;
+    }
+
+    // Automation: @t=v,t=v,...
+    const char *p = at + 1;
+    size_t capacity = 1;
+    for (const char *c = p; *c; c++) capacity += (*c == ',');
+    free(setting->automation);
+    setting->automation = calloc(capacity, sizeof(StemMixerPoint));
+    setting->automationCount = 0;
+    if (!setting->automation) return -1;
+
+    while (*p) {
+        char *end;
+        double time = strtod(p, &end);
+        if (*end != '=') return -1;
+        float value = strtof(end + 1, &end);
+        if (*end != ',' && *end != '\0') return -1;
+        setting->automation[setting->automationCount].time = time;
+        setting->automation[setting->automationCount].value = value;
+        setting->automationCount++;
+        p = (*end == ',') ? end + 1 : end;
+    }
+    qsort(setting->automation, setting->automationCount, sizeof(StemMixerPoint), CompareByTime);
+    return 0;
+}
+
+static void FreeJob(MixJob *job) {
+    free(job->songDir);
+    free(job->outputPath);
+    for (size_t s = 0; s < job->settingCount; s++) free(job->settings[s].automation);
+}
+
+// Lines that cannot be parsed are reported, counted in *outRejected and skipped
+static MixJob *ReadJobFile(const char *path, size_t *outCount, size_t *outRejected) {
+    FILE *file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!file) return NULL;
+
+    size_t count = 0, rejected = 0, capacity = 64;
+    MixJob *jobs = calloc(capacity, sizeof(MixJob));
+    char line[8192];
+    unsigned lineNumber = 0;
+
+    while (jobs && fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        char *tokens[MAX_SETTINGS + 3];
+        size_t tokenCount = Tokenize(line, tokens, MAX_SETTINGS + 3);
+        if (tokenCount == 0) continue;
+        if (tokenCount < 2) {
+            fprintf(stderr, "%s:%u: expected <song_dir> <output.wav> [settings]\n", path, lineNumber);
+            rejected++;
+            continue;
+        }
+
+        if (count == capacity) {
+            capacity *= 2;
+            MixJob *grown = realloc(jobs, capacity * sizeof(MixJob));
+            if (!grown) break;
+            jobs = grown;
+        }
+
+        MixJob *job = &jobs[count];
+        memset(job, 0, sizeof(*job));
+        job->songDir = strdup(tokens[0]);
+        job->outputPath = strdup(tokens[1]);
+        int valid = 1;
+        for (size_t t = 2; t < tokenCount; t++) {
+            if (ParseSetting(job, tokens[t]) != 0) {
+                fprintf(stderr, "%s:%u: bad setting '%s'\n", path, lineNumber, tokens[t]);
+                valid = 0;
+            }
+        }
+        if (valid && job->songDir && job->outputPath) {
+            count++;
+        } else {
+            FreeJob(job);
+            rejected++;
+        }
+    }
+
+    if (file != stdin) fclose(file);
+    *outCount = count;
+    *outRejected = rejected;
+    return jobs;
+}
+
+static void FreeJobs(MixJob *jobs, size_t count) {
+    for (size_t i = 0; i < count; i++) FreeJob(&jobs[i]);
+    free(jobs);
+}
+
+#pragma mark - Rendering
+
+static int InSoloList(const char *solo, const char *name) {
+    size_t length = strlen(name);
+    for (const char *p = solo; *p;) {
+        const char *comma = strchr(p, ',');
+        size_t itemLength = comma ? (size_t)(comma - p) : strlen(p);
+        if (itemLength == length && strncasecmp(p, name, length) == 0) return 1;
+        p += itemLength + (comma ? 1 : 0);
+    }
+    return 0;
+}
+
+static int CompareNames(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static int HasExtension(const char *name, const char *extension) {
+    size_t length = strlen(name);
+    return length > 4 && strcasecmp(name + length - 4, extension) == 0;
+}
+
+// Same stem in the other format: "drums.wav" and "drums.mp3"
+static int IsTwin(const char *wavName, const char *name) {
+    size_t length = strlen(wavName);
+    return strlen(name) == length && HasExtension(name, ".mp3") && strncasecmp(wavName, name, length - 4) == 0;
+}
+
+// Collects *.wav and *.mp3 stems in name order so renders are deterministic. A
+// stem present in both formats is mixed once, from the MP3 the app plays.
+// Returns the count, 0 (with a message) if there are none or more than the
+// mixer takes.
+static size_t ListStems(const char *songDir, char **names, int warn) {
+    DIR *dir = opendir(songDir);
+    char **found = NULL;
+    size_t count = 0, capacity = 0;
+    struct dirent *entry;
+    while (dir && (entry = readdir(dir))) {
+        if (!HasExtension(entry->d_name, ".wav") && !HasExtension(entry->d_name, ".mp3")) continue;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            char **grown = realloc(found, capacity * sizeof(char *));
+            if (!grown) break;
+            found = grown;
+        }
+        if (!(found[count] = strdup(entry->d_name))) break;
+        count++;
+    }
+    if (dir) closedir(dir);
+
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        int twin = 0;
+        for (size_t j = 0; j < count && HasExtension(found[i], ".wav"); j++) twin |= IsTwin(found[i], found[j]);
+        if (twin) {
+            if (warn) fprintf(stderr, "%s/%s: also cached as MP3, using that\n", songDir, found[i]);
+            free(found[i]);
+        } else {
+            found[kept++] = found[i];
+        }
+    }
+
+    if (kept == 0) {
+        fprintf(stderr, "%s: no WAV or MP3 stems\n", songDir);
+    } else if (kept > STEM_MIXER_MAX_STEMS) {
+        fprintf(stderr, "%s: more than %d stems\n", songDir, STEM_MIXER_MAX_STEMS);
+        for (size_t i = 0; i < kept; i++) free(found[i]);
+        kept = 0;
+    }
+    qsort(found, kept, sizeof(char *), CompareNames);
+    if (kept > 0) memcpy(names, found, kept * sizeof(char *));
+    free(found);
+    return kept;
+}
+
+static int StemInputOpen(StemInput *input, const char *path) {
+    input->isMp3 = HasExtension(path, ".mp3");
+    if (input->isMp3) {
+        if (StemMp3ReaderOpen(&input->mp3, path) != 0) return -1;
+        input->sampleRate = input->mp3.sampleRate;
+        input->channelCount = input->mp3.channelCount;
+    } else {
+        if (StemWavReaderOpen(&input->wav, path) != 0) return -1;
+        input->sampleRate = input->wav.sampleRate;
+        input->channelCount = input->wav.channelCount;
+    }
+    return 0;
+}
+
+static size_t StemInputRead(StemInput *input, float *interleaved, size_t maxFrames) {
+    return input->isMp3 ? StemMp3ReaderRead(&input->mp3, interleaved, maxFrames)
+                        : StemWavReaderRead(&input->wav, interleaved, maxFrames);
+}
+
+// Heap and stdio buffer bytes the open stem holds while streaming
+static size_t StemInputBufferBytes(const StemInput *input) {
+    return BUFSIZ + (input->isMp3 ? StemMp3ReaderBufferBytes(&input->mp3) : input->wav.scratchSize);
+}
+
+static void StemInputClose(StemInput *input) {
+    if (input->isMp3) StemMp3ReaderClose(&input->mp3);
+    else StemWavReaderClose(&input->wav);
+}
+
+// Stem name from its file name: "drums.mp3" -> "drums"
+static void StemNameForFile(const char *fileName, char *name, size_t size) {
+    snprintf(name, size, "%.*s", (int)(strlen(fileName) - 4), fileName);
+}
+
+static int SongHasStem(char *const *names, size_t stemCount, const char *stemName, size_t length) {
+    char name[MAX_NAME];
+    for (size_t s = 0; s < stemCount; s++) {
+        StemNameForFile(names[s], name, sizeof(name));
+        if (strlen(name) == length && strncasecmp(name, stemName, length) == 0) return 1;
+    }
+    return 0;
+}
+
+// A typo in a stem name would otherwise leave that stem at the default fader silently
+static void WarnUnknownStems(const MixJob *job, char *const *names, size_t stemCount) {
+    for (size_t i = 0; i < job->settingCount; i++) {
+        const char *name = job->settings[i].name;
+        if (!SongHasStem(names, stemCount, name, strlen(name))) {
+            fprintf(stderr, "%s: warning: no stem named '%s', setting ignored\n", job->songDir, name);
+        }
+    }
+    for (const char *p = job->solo; *p;) {
+        const char *comma = strchr(p, ',');
+        size_t length = comma ? (size_t)(comma - p) : strlen(p);
+        if (!SongHasStem(names, stemCount, p, length)) {
+            fprintf(stderr, "%s: warning: no stem named '%.*s' in solo list\n", job->songDir, (int)length, p);
+        }
+        p += length + (comma ? 1 : 0);
+    }
+}
+
+static int RenderJob(const MixBatch *batch, MixJob *job) {
+    char *names[STEM_MIXER_MAX_STEMS];
+    size_t stemCount = ListStems(job->songDir, names, !batch->quiet);
+    if (stemCount == 0) return -1;
+    if (!batch->quiet) WarnUnknownStems(job, names, stemCount);
+
+    StemInput *readers = malloc(stemCount * sizeof(StemInput));
+    StemMixerChannel channels[STEM_MIXER_MAX_STEMS];
+    uint16_t inputChannels[STEM_MIXER_MAX_STEMS];
+    size_t inputFrames[STEM_MIXER_MAX_STEMS];
+    float *inputs[STEM_MIXER_MAX_STEMS] = {0};
+    float *output = NULL;
+    size_t opened = 0;
+    uint16_t outputChannels = 1;
+    uint32_t sampleRate = 0;
+    int status = -1;
+    if (!readers) goto done;
+
+    for (; opened < stemCount; opened++) {
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/%s", job->songDir, names[opened]);
+        if (StemInputOpen(&readers[opened], path) != 0) {
+            fprintf(stderr, "%s: unreadable stem\n", path);
+            goto done;
+        }
+        if (opened > 0 && readers[opened].sampleRate != sampleRate) {
+            fprintf(stderr, "%s: sample rate %u differs from %u\n", path, readers[opened].sampleRate, sampleRate);
+            StemInputClose(&readers[opened]);
+            goto done;
+        }
+        sampleRate = readers[opened].sampleRate;
+        inputChannels[opened] = readers[opened].channelCount;
+        if (inputChannels[opened] > outputChannels) outputChannels = inputChannels[opened];
+
+        // Fader state for this stem: explicit setting, else the app's default
+        char stemName[MAX_NAME];
+        StemNameForFile(names[opened], stemName, sizeof(stemName));
+        StemMixerChannel *channel = &channels[opened];
+        channel->value = STEM_MIXER_DEFAULT_FADER;
+        channel->muted = job->solo[0] && !InSoloList(job->solo, stemName);
+        channel->automation = NULL;
+        channel->automationCount = 0;
+        StemSetting *setting = NULL;
+        for (size_t i = 0; i < job->settingCount; i++) {
+            if (strcasecmp(job->settings[i].name, stemName) == 0) setting = &job->settings[i];
+        }
+        if (setting) {
+            if (setting->hasValue) channel->value = setting->value;
+            channel->muted |= setting->muted;
+            channel->automation = setting->automation;
+            channel->automationCount = setting->automationCount;
+        }
+    }
+
+    size_t block = batch->blockFrames;
+    size_t bufferBytes = block * outputChannels * sizeof(float);
+    output = malloc(block * outputChannels * sizeof(float));
+    for (size_t s = 0; s < stemCount; s++) {
+        inputs[s] = malloc(block * inputChannels[s] * sizeof(float));
+        bufferBytes += block * inputChannels[s] * sizeof(float);
+        if (!inputs[s]) goto done;
+    }
+    if (!output) goto done;
+
+    StemWavWriter writer;
+    if (StemWavWriterOpen(&writer, job->outputPath, sampleRate, outputChannels, batch->floatOutput) != 0) {
+        fprintf(stderr, "%s: cannot create output\n", job->outputPath);
+        goto done;
+    }
+
+    uint64_t position = 0;
+    int writeFailed = 0;
+    for (;;) {
+        size_t frames = 0;
+        for (size_t s = 0; s < stemCount; s++) {
+            inputFrames[s] = StemInputRead(&readers[s], inputs[s], block);
+            if (inputFrames[s] > frames) frames = inputFrames[s];
+        }
+        if (frames == 0) break;
+
+        StemMixerMixBlock(channels, (const float *const *)inputs, inputChannels, inputFrames, stemCount,
+                          output, outputChannels, frames, (double)position / sampleRate, sampleRate);
+        if (StemWavWriterWrite(&writer, output, frames) != 0) {
+            writeFailed = 1;
+            break;
+        }
+        position += frames;
+    }
+
+    // Reader and writer scratch buffers have grown to their block size by now.
+    // A stem without a valid seek sidecar also holds the whole MP3 briefly
+    // while the table is built at open; that is not counted here.
+    for (size_t s = 0; s < stemCount; s++) bufferBytes += StemInputBufferBytes(&readers[s]);
+    job->peakBufferBytes = bufferBytes + writer.scratchSize + BUFSIZ;
+
+    if (StemWavWriterClose(&writer) != 0 || writeFailed) {
+        fprintf(stderr, "%s: write failed\n", job->outputPath);
+        goto done;
+    }
+    job->audioSeconds = (double)position / sampleRate;
+    status = 0;
+
+done:
+    for (size_t s = 0; s < opened; s++) StemInputClose(&readers[s]);
+    free(readers);
+    for (size_t s = 0; s < stemCount; s++) {
+        free(inputs[s]);
+        free(names[s]);
+    }
+    free(output);
+    return status;
+}
+
+static void RunJob(void *context, size_t jobIndex, unsigned workerIndex) {
+    MixBatch *batch = context;
+    MixJob *job = &batch->jobs[jobIndex];
+
+    double start = NowSeconds(CLOCK_MONOTONIC);
+    job->failed = RenderJob(batch, job) != 0;
+    job->wallSeconds = NowSeconds(CLOCK_MONOTONIC) - start;
+
+    if (batch->quiet) return;
+    pthread_mutex_lock(&batch->reportLock);
+    if (job->failed) {
+        printf("[w%u] FAIL %s\n", workerIndex, job->outputPath);
+    } else {
+        printf("[w%u] %s: %.1fs audio in %.3fs (%.0fx real time)\n", workerIndex, job->outputPath,
+               job->audioSeconds, job->wallSeconds,
+               job->wallSeconds > 0.0 ? job->audioSeconds / job->wallSeconds : 0.0);
+    }
+    fflush(stdout);
+    pthread_mutex_unlock(&batch->reportLock);
+}
+
+#pragma mark - Main
+
+typedef struct {
+    double wall;
+    double cpu;
+    size_t stolen;
+    unsigned workers;         // Threads that actually ran jobs
+} BatchTiming;
+
+static void RunBatch(MixBatch *batch, unsigned workers, BatchTiming *timing) {
+    for (size_t i = 0; i < batch->jobCount; i++) {
+        batch->jobs[i].failed = 0;
+        batch->jobs[i].audioSeconds = 0.0;
+    }
+
+    StemWorkerStats *stats = calloc(workers, sizeof(StemWorkerStats));
+    double wallStart = NowSeconds(CLOCK_MONOTONIC);
+    double cpuStart = NowSeconds(CLOCK_PROCESS_CPUTIME_ID);
+    int missing = StemWorkPoolRun(batch->jobCount, workers, RunJob, batch, stats);
+    timing->wall = NowSeconds(CLOCK_MONOTONIC) - wallStart;
+    timing->cpu = NowSeconds(CLOCK_PROCESS_CPUTIME_ID) - cpuStart;
+    timing->workers = workers;
+
+    if (missing < 0) {
+        fprintf(stderr, "cannot start the worker pool\n");
+        for (size_t i = 0; i < batch->jobCount; i++) batch->jobs[i].failed = 1;
+    } else if (missing > 0) {
+        timing->workers = workers - (unsigned)missing;
+        fprintf(stderr, "warning: %d of %u worker threads could not be started, ran on %u\n",
+                missing, workers, timing->workers);
+    }
+
+    timing->stolen = 0;
+    for (unsigned w = 0; w < workers && stats; w++) timing->stolen += stats[w].stolen;
+    free(stats);
+}
+
+static void Usage(const char *program) {
+    fprintf(stderr, "usage: %s [-j workers] [-b block_frames] [-F] [-s] jobs.txt|-\n", program);
+    fprintf(stderr, "  -j N  worker threads (default: online CPU count)\n");
+    fprintf(stderr, "  -b N  frames per streaming block (default 16384)\n");
+    fprintf(stderr, "  -F    write 32-bit float WAV instead of 16-bit PCM\n");
+    fprintf(stderr, "  -s    render the batch on one worker first and report the speedup\n");
+}
+
+int main(int argc, char *argv[]) {
+    long workers = sysconf(_SC_NPROCESSORS_ONLN);
+    long blockFrames = 16384;
+    int floatOutput = 0;
+    int baseline = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:b:Fsh")) != -1) {
+        switch (opt) {
+            case 'j': workers = strtol(optarg, NULL, 10); break;
+            case 'b': blockFrames = strtol(optarg, NULL, 10); break;
+            case 'F': floatOutput = 1; break;
+            case 's': baseline = 1; break;
+            default: Usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (optind != argc - 1 || blockFrames < 64) {
+        Usage(argv[0]);
+        return 2;
+    }
+    if (workers < 1) workers = 1;
+
+    MixBatch batch;
+    memset(&batch, 0, sizeof(batch));
+    size_t rejected = 0;
+    batch.jobs = ReadJobFile(argv[optind], &batch.jobCount, &rejected);
+    if (!batch.jobs) {
+        fprintf(stderr, "%s: cannot read job file\n", argv[optind]);
+        return 2;
+    }
+    batch.blockFrames = (size_t)blockFrames;
+    batch.floatOutput = floatOutput;
+    pthread_mutex_init(&batch.reportLock, NULL);
+
+    // Same jobs on a single worker: the reference for the parallel speedup
+    BatchTiming single = {0};
+    if (baseline) {
+        batch.quiet = 1;
+        RunBatch(&batch, 1, &single);
+        batch.quiet = 0;
+    }
+
+    BatchTiming timing;
+    RunBatch(&batch, (unsigned)workers, &timing);
+
+    size_t failed = 0, peakBytes = 0;
+    double audio = 0.0;
+    for (size_t i = 0; i < batch.jobCount; i++) {
+        failed += batch.jobs[i].failed;
+        audio += batch.jobs[i].audioSeconds;
+        if (batch.jobs[i].peakBufferBytes > peakBytes) peakBytes = batch.jobs[i].peakBufferBytes;
+    }
+
+    printf("\n%zu jobs (%zu failed) on %u workers, %zu stolen\n", batch.jobCount, failed, timing.workers,
+           timing.stolen);
+    if (rejected) printf("%zu malformed job lines skipped\n", rejected);
+    printf("%.1fs audio in %.2fs wall, %.2fs cpu: %.0fx real time aggregate, %.0fx per core\n",
+           audio, timing.wall, timing.cpu, timing.wall > 0.0 ? audio / timing.wall : 0.0,
+           timing.cpu > 0.0 ? audio / timing.cpu : 0.0);
+    if (baseline) {
+        double speedup = timing.wall > 0.0 ? single.wall / timing.wall : 0.0;
+        printf("1 worker %.2fs wall -> %u workers %.2fs: %.2fx speedup (%.0f%% of linear)\n",
+               single.wall, timing.workers, timing.wall, speedup, 100.0 * speedup / timing.workers);
+    }
+    printf("stream buffers %.1f KiB per worker\n", peakBytes / 1024.0);
+
+    pthread_mutex_destroy(&batch.reportLock);
+    FreeJobs(batch.jobs, batch.jobCount);
+    return failed || rejected ? 1 : 0;
+}
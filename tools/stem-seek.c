@@ -0,0 +1,230 @@
+//
+//  stem-seek.c
+//  Builds MP3 seek-table sidecars and benchmarks seek cost
+//
+//  For each stem the table is built (or loaded from <stem>.seek) and
+//  round-tripped through the sidecar format. The stem is then decoded linearly
+//  from the start, and every random seek decodes a window through a freshly
+//  reset decoder from the table's start frame; the window must be bit-identical
+//  to the same samples of the linear decode. The report compares frames
+//  decoded per seek with decoding linearly from the start.
+//
+
+#include "StemMp3Reader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Keeps the timed locate loop from being optimised away
+static volatile uint64_t gLocateSink;
+
+static double NowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t NextRandom(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static int TablesEqual(const StemSeekTable *a, const StemSeekTable *b) {
+    return a->sampleRate == b->sampleRate && a->channelCount == b->channelCount &&
+           a->samplesPerFrame == b->samplesPerFrame && a->encoderDelay == b->encoderDelay &&
+           a->encoderPadding == b->encoderPadding && a->primingSamples == b->primingSamples &&
+           a->sampleCount == b->sampleCount && a->frameCount == b->frameCount &&
+           memcmp(a->frameOffsets, b->frameOffsets, ((size_t)a->frameCount + 1) * sizeof(uint32_t)) == 0 &&
+           memcmp(a->reservoirFrames, b->reservoirFrames, a->frameCount) == 0;
+}
+
+// Samples compared after each seek; spans several frames past the target
+#define SEEK_WINDOW 4096
+
+// Whole stem through one decoder, never reset. NULL on failure.
+static float *DecodeLinear(const char *path, uint64_t *frameCount, uint16_t *channelCount) {
+    StemMp3Reader reader;
+    if (StemMp3ReaderOpen(&reader, path) != 0) return NULL;
+    float *pcm = malloc((size_t)(reader.frameCount ? reader.frameCount : 1) * reader.channelCount * sizeof(float));
+    size_t got = pcm ? StemMp3ReaderRead(&reader, pcm, (size_t)reader.frameCount) : 0;
+    if (pcm && got != reader.frameCount) {
+        free(pcm);
+        pcm = NULL;
+    }
+    *frameCount = reader.frameCount;
+    *channelCount = reader.channelCount;
+    StemMp3ReaderClose(&reader);
+    return pcm;
+}
+
+static int CheckStem(const char *path, unsigned seekCount, int force) {
+    FILE *file = fopen(path, "rb");
+    struct stat info;
+    if (!file || fstat(fileno(file), &info) != 0) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        if (file) fclose(file);
+        return -1;
+    }
+    size_t size = (size_t)info.st_size;
+    int64_t modified = (int64_t)info.st_mtime;
+    uint8_t *data = size > 0 ? malloc(size) : NULL;
+    int readOK = data && fread(data, 1, size, file) == size;
+    fclose(file);
+    if (!readOK) {
+        fprintf(stderr, "%s: read failed\n", path);
+        free(data);
+        return -1;
+    }
+
+    char sidecarPath[4096];
+    snprintf(sidecarPath, sizeof(sidecarPath), "%s%s", path, STEM_SEEK_SIDECAR_EXTENSION);
+    if (force) remove(sidecarPath);
+
+    StemSeekTable built;
+    double buildStart = NowSeconds();
+    if (StemSeekTableBuild(data, size, &built) != 0) {
+        fprintf(stderr, "%s: no MPEG Layer III frames\n", path);
+        free(data);
+        return -1;
+    }
+    double buildTime = NowSeconds() - buildStart;
+
+    StemSeekTable loaded;
+    if (StemSeekTableLoadOrBuild(path, &loaded) != 0) {
+        fprintf(stderr, "%s: sidecar build failed\n", path);
+        StemSeekTableFree(&built);
+        free(data);
+        return -1;
+    }
+    StemSeekTableFree(&loaded);
+
+    double loadStart = NowSeconds();
+    int loadOK = StemSeekTableReadSidecar(sidecarPath, &loaded, size, modified) == 0;
+    double loadTime = NowSeconds() - loadStart;
+
+    int failures = 0;
+    if (!loadOK || !TablesEqual(&built, &loaded)) {
+        fprintf(stderr, "%s: sidecar does not round-trip\n", path);
+        failures++;
+    }
+
+    // A same-size replacement must invalidate the sidecar
+    StemSeekTable stale;
+    if (StemSeekTableReadSidecar(sidecarPath, &stale, size, modified + 1) == 0) {
+        fprintf(stderr, "%s: sidecar accepted for a modified stem\n", path);
+        StemSeekTableFree(&stale);
+        failures++;
+    }
+
+    // Random seeks: seek-then-decode must match the linear decode exactly
+    uint64_t linearCount = 0;
+    uint16_t channels = 0;
+    float *linear = seekCount ? DecodeLinear(path, &linearCount, &channels) : NULL;
+    float *window = malloc(SEEK_WINDOW * 2 * sizeof(float));
+    StemMp3Reader reader;
+    int readerOK = seekCount && StemMp3ReaderOpen(&reader, path) == 0;
+    if (seekCount && (!linear || !window || !readerOK || linearCount != built.sampleCount)) {
+        fprintf(stderr, "%s: linear decode failed\n", path);
+        failures++;
+        seekCount = 0;
+    }
+
+    uint64_t rng = 0x9E3779B97F4A7C15ull ^ (uint64_t)size;
+    uint64_t framesDecoded = 0, linearFrames = 0, mismatches = 0;
+    uint32_t worstFrames = 0;
+    double seekTime = 0.0;
+    StemSeekPoint point;
+    for (unsigned i = 0; i < seekCount && built.sampleCount > 0; i++) {
+        uint64_t sample = NextRandom(&rng) % built.sampleCount;
+        size_t want = built.sampleCount - sample < SEEK_WINDOW ? (size_t)(built.sampleCount - sample) : SEEK_WINDOW;
+
+        double seekStart = NowSeconds();
+        int seekOK = StemMp3ReaderSeek(&reader, sample) == 0 && StemMp3ReaderRead(&reader, window, want) == want;
+        seekTime += NowSeconds() - seekStart;
+
+        if (!seekOK || memcmp(window, linear + sample * channels, want * channels * sizeof(float)) != 0) {
+            if (mismatches++ < 5) {
+                fprintf(stderr, "%s: seek to %llu does not match the linear decode\n",
+                        path, (unsigned long long)sample);
+            }
+            continue;
+        }
+
+        StemSeekTableLocate(&built, sample, &point);
+        uint32_t frames = point.targetFrame - point.decodeFrame + 1;
+        framesDecoded += frames;
+        linearFrames += point.targetFrame + 1;
+        if (frames > worstFrames) worstFrames = frames;
+    }
+    if (mismatches) failures++;
+    if (readerOK) StemMp3ReaderClose(&reader);
+    free(window);
+    free(linear);
+
+    // Locate latency
+    unsigned iterations = 1000000;
+    uint64_t checksum = 0;
+    double locateStart = NowSeconds();
+    for (unsigned i = 0; i < iterations && built.sampleCount > 0; i++) {
+        StemSeekTableLocate(&built, NextRandom(&rng) % built.sampleCount, &point);
+        checksum += point.byteOffset;
+    }
+    double locateTime = NowSeconds() - locateStart;
+    gLocateSink = checksum;
+
+    double seconds = (double)built.sampleCount / built.sampleRate;
+    printf("%s: %u frames, %.1fs @ %u Hz, delay %u, padding %u%s\n",
+           path, built.frameCount, seconds, built.sampleRate, built.encoderDelay, built.encoderPadding,
+           failures ? " FAILED" : "");
+    printf("  build %.2f ms (%.0f MB/s), sidecar load %.3f ms, locate %.1f ns\n",
+           buildTime * 1e3, size / 1e6 / (buildTime > 0 ? buildTime : 1e-9), loadTime * 1e3,
+           locateTime * 1e9 / iterations);
+    if (seekCount) {
+        unsigned matched = seekCount - (unsigned)mismatches;
+        printf("  %u/%u seeks bit-identical to linear decode, %.1f us per seek + %d-sample read\n",
+               matched, seekCount, seekTime * 1e6 / seekCount, SEEK_WINDOW);
+        printf("  frames decoded per seek: mean %.2f, worst %u (linear decode: mean %.0f)\n",
+               matched ? (double)framesDecoded / matched : 0.0, worstFrames,
+               matched ? (double)linearFrames / matched : 0.0);
+    }
+
+    StemSeekTableFree(&built);
+    StemSeekTableFree(&loaded);
+    free(data);
+    return failures ? -1 : 0;
+}
+
+static void Usage(const char *program) {
+    fprintf(stderr, "usage: %s [-n seeks] [-f] stem.mp3...\n", program);
+    fprintf(stderr, "  -n N  random seeks to compare with a linear decode (default 10000)\n");
+    fprintf(stderr, "  -f    rebuild existing %s sidecars\n", STEM_SEEK_SIDECAR_EXTENSION);
+}
+
+int main(int argc, char *argv[]) {
+    unsigned seekCount = 10000;
+    int force = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:fh")) != -1) {
+        switch (opt) {
+            case 'n': seekCount = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'f': force = 1; break;
+            default: Usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (optind >= argc) {
+        Usage(argv[0]);
+        return 2;
+    }
+
+    int failed = 0;
+    for (int i = optind; i < argc; i++) {
+        if (CheckStem(argv[i], seekCount, force) != 0) failed++;
+    }
+    return failed ? 1 : 0;
+}